@@ -0,0 +1,116 @@
+#ifndef MATRIX_ASYNCMATRIX_CPP
+#define MATRIX_ASYNCMATRIX_CPP
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "OperationControl.h"
+#include "SquareMatrix.cpp"
+#include "ThreadPool.h"
+
+// Handle of an operation running on the operation pool. Dropping the handle
+// doesn't stop the operation, call cancel() for that: the operation stops at
+// its next block boundary and get() throws OperationCancelledError.
+template <typename R>
+class AsyncOperation {
+ public:
+  AsyncOperation(std::future<R> result,
+                 std::shared_ptr<OperationControl> control)
+      : result_(std::move(result)), control_(std::move(control)) {}
+
+  R get() { return result_.get(); }
+  void wait() const { result_.wait(); }
+  bool isReady() const {
+    return result_.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+
+  void cancel() { control_->cancel(); }
+  double getProgress() const { return control_->getProgress(); }
+
+ private:
+  std::future<R> result_;
+  std::shared_ptr<OperationControl> control_;
+};
+
+// Computes the product by blocks of rows on the matrix pool, one step per
+// block. Blocks not started before cancellation are skipped.
+template <typename T>
+Matrix<T> MultiplyByBlocks(const Matrix<T>& lmx, const Matrix<T>& rmx,
+                           OperationControl& control) {
+  if (lmx.width_ != rmx.height_) {
+    throw MatrixWrongSizeError();
+  }
+  Matrix<T> newMatrix(lmx.height_, rmx.width_);
+  control.setTotalSteps((lmx.height_ + kGemmRowsBlock - 1) / kGemmRowsBlock);
+  std::vector<std::future<void>> blocksDone;
+  for (int first = 0; first < lmx.height_; first += kGemmRowsBlock) {
+    int rows = std::min(kGemmRowsBlock, lmx.height_ - first);
+    const T* const* lRows = lmx.matrixField_ + first;
+    const T* const* rRows = rmx.matrixField_;
+    T* const* newRows = newMatrix.matrixField_ + first;
+    int width = rmx.width_;
+    int depth = lmx.width_;
+    OperationControl* blockControl = &control;
+    blocksDone.push_back(getMatrixThreadPool().submit(
+        [rows, width, depth, lRows, rRows, newRows, blockControl]() {
+          if (blockControl->isCancelled()) {
+            return;
+          }
+          GemmKernel<T, false>(rows, width, depth, lRows, 0, rRows, 0,
+                               newRows, 0);
+          blockControl->completeStep();
+        }));
+  }
+  for (std::future<void>& done : blocksDone) {
+    done.get();
+  }
+  control.ThrowIfCancelled();
+  return newMatrix;
+}
+
+// The operands are copied, so the caller may change or destroy them while
+// the operation runs. onProgress receives the finished fraction of the work.
+template <typename T>
+AsyncOperation<Matrix<T>> multiplyAsync(
+    const Matrix<T>& lmx, const Matrix<T>& rmx,
+    std::function<void(double)> onProgress = nullptr) {
+  auto control = std::make_shared<OperationControl>(std::move(onProgress));
+  auto operands = std::make_shared<std::pair<Matrix<T>, Matrix<T>>>(lmx, rmx);
+  std::future<Matrix<T>> result =
+      getOperationThreadPool().submit([operands, control]() {
+        control->ThrowIfCancelled();
+        return MultiplyByBlocks(operands->first, operands->second, *control);
+      });
+  return AsyncOperation<Matrix<T>>(std::move(result), control);
+}
+
+template <typename T>
+AsyncOperation<T> determinantAsync(
+    const SquareMatrix<T>& matrix,
+    std::function<void(double)> onProgress = nullptr) {
+  auto control = std::make_shared<OperationControl>(std::move(onProgress));
+  auto operand = std::make_shared<SquareMatrix<T>>(matrix);
+  std::future<T> result =
+      getOperationThreadPool().submit([operand, control]() {
+        return operand->getDeterminant(control.get());
+      });
+  return AsyncOperation<T>(std::move(result), control);
+}
+
+template <typename T>
+AsyncOperation<SquareMatrix<T>> inverseAsync(
+    const SquareMatrix<T>& matrix,
+    std::function<void(double)> onProgress = nullptr) {
+  auto control = std::make_shared<OperationControl>(std::move(onProgress));
+  auto operand = std::make_shared<SquareMatrix<T>>(matrix);
+  std::future<SquareMatrix<T>> result =
+      getOperationThreadPool().submit([operand, control]() {
+        return operand->getInverse(control.get());
+      });
+  return AsyncOperation<SquareMatrix<T>>(std::move(result), control);
+}
+
+#endif
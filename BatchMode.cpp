@@ -0,0 +1,256 @@
+#include "BatchMode.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "Rational.h"
+#include "SquareMatrix.cpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Operands with more elements are rejected before they are allocated.
+const long long kMaxOperandElements = 1LL << 26;
+
+enum class Operation { kMultiply, kDeterminant, kInverse, kPower };
+
+struct Job {
+  int id = 0;
+  Operation operation = Operation::kMultiply;
+  std::string description;
+  std::vector<Matrix<Rational>> operands;
+  long long exponent = 0;
+  // Set when the job couldn't be parsed, the job is then not computed.
+  std::string error;
+  Clock::time_point submitted;
+};
+
+struct JobResult {
+  int id = 0;
+  std::string description;
+  bool isScalar = false;
+  Rational scalar;
+  Matrix<Rational> matrix;
+  std::string error;
+  Clock::time_point submitted;
+  Clock::time_point computeStarted;
+  Clock::time_point computeFinished;
+};
+
+double Milliseconds(const Clock::time_point from, const Clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+Matrix<Rational> ReadMatrix(std::istream& is, const int height,
+                            const int width) {
+  if (static_cast<long long>(height) * width > kMaxOperandElements) {
+    throw std::length_error("operand " + std::to_string(height) + 'x' +
+                            std::to_string(width) + " is too large");
+  }
+  Matrix<Rational> matrix(height, width);
+  is >> matrix;
+  return matrix;
+}
+
+// Returns false when the input is over. After a malformed job the position in
+// the stream is unknown, so the job is returned with an error and the caller
+// stops reading. An operand that is too large or cannot be allocated makes
+// the job malformed the same way.
+bool ReadJob(std::istream& is, Job& job) {
+  std::string name;
+  if (!(is >> name)) {
+    return false;
+  }
+  std::ostringstream description;
+  description << name;
+  int height = 0;
+  int width = 0;
+  try {
+    if (name == "multiply") {
+      int depth = 0;
+      if (is >> height >> depth >> width && height > 0 && depth > 0 &&
+          width > 0) {
+        job.operation = Operation::kMultiply;
+        description << ' ' << height << 'x' << depth << " * " << depth << 'x'
+                    << width;
+        job.operands.push_back(ReadMatrix(is, height, depth));
+        job.operands.push_back(ReadMatrix(is, depth, width));
+      }
+    } else if (name == "determinant" || name == "inverse" || name == "power") {
+      if (is >> height && height > 0 &&
+          (name != "power" || is >> job.exponent)) {
+        job.operation = name == "determinant" ? Operation::kDeterminant
+                        : name == "inverse"   ? Operation::kInverse
+                                              : Operation::kPower;
+        description << ' ' << height << 'x' << height;
+        if (name == "power") {
+          description << " ^ " << job.exponent;
+        }
+        job.operands.push_back(ReadMatrix(is, height, height));
+      }
+    } else {
+      job.error = "unknown operation '" + name + "'";
+    }
+  } catch (const std::exception& error) {
+    job.error = error.what();
+  }
+  if (job.error.empty() && (!is || job.operands.empty())) {
+    job.error = "malformed " + name + " job";
+  }
+  job.description = description.str();
+  return true;
+}
+
+void ComputeJob(const Job& job, JobResult& result) {
+  result.id = job.id;
+  result.description = job.description;
+  result.submitted = job.submitted;
+  result.error = job.error;
+  result.computeStarted = Clock::now();
+  if (result.error.empty()) {
+    try {
+      switch (job.operation) {
+        case Operation::kMultiply:
+          result.matrix = job.operands[0] * job.operands[1];
+          break;
+        case Operation::kDeterminant:
+          result.isScalar = true;
+          result.scalar =
+              SquareMatrix<Rational>(job.operands[0]).getDeterminant();
+          break;
+        case Operation::kInverse:
+          result.matrix = SquareMatrix<Rational>(job.operands[0]).getInverse();
+          break;
+        case Operation::kPower:
+          result.matrix =
+              SquareMatrix<Rational>(job.operands[0]).getPower(job.exponent);
+          break;
+      }
+    } catch (const std::exception& error) {
+      result.error = error.what();
+    }
+  }
+  result.computeFinished = Clock::now();
+}
+
+std::string FormatResult(const JobResult& result) {
+  std::ostringstream os;
+  if (!result.error.empty()) {
+    os << "error: " << result.error << '\n';
+  } else if (result.isScalar) {
+    os << result.scalar << '\n';
+  } else {
+    os << result.matrix;
+  }
+  os << '\n';
+  return os.str();
+}
+
+}  // namespace
+
+int RunBatchMode(std::istream& input, std::ostream& output, std::ostream& log,
+                 const int workersNumber) {
+  const int capacity = 2 * workersNumber;
+  BoundedQueue<Job> parsed(capacity);
+  BoundedQueue<JobResult> computed(capacity);
+  // A job takes a ticket when it is parsed and returns it when its result is
+  // written, which bounds the results waiting for their turn to be written.
+  BoundedQueue<int> tickets(2 * capacity + workersNumber);
+  for (int i = 0; i < 2 * capacity + workersNumber; ++i) {
+    tickets.push(i);
+  }
+
+  Clock::time_point started = Clock::now();
+  std::thread parser([&input, &parsed, &tickets]() {
+    int ticket = 0;
+    for (int id = 0; tickets.pop(ticket); ++id) {
+      Job job;
+      if (!ReadJob(input, job)) {
+        break;
+      }
+      job.id = id;
+      job.submitted = Clock::now();
+      bool isMalformed = !job.error.empty();
+      parsed.push(std::move(job));
+      if (isMalformed) {
+        break;
+      }
+    }
+    parsed.close();
+  });
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < workersNumber; ++i) {
+    workers.emplace_back([&parsed, &computed]() {
+      Job job;
+      while (parsed.pop(job)) {
+        JobResult result;
+        ComputeJob(job, result);
+        computed.push(std::move(result));
+      }
+    });
+  }
+  std::thread closer([&workers, &computed]() {
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    computed.close();
+  });
+
+  std::map<int, JobResult> pending;
+  std::vector<double> latencies;
+  int failedJobs = 0;
+  JobResult result;
+  while (computed.pop(result)) {
+    int id = result.id;
+    pending.emplace(id, std::move(result));
+    for (auto next = pending.find(static_cast<int>(latencies.size()));
+         next != pending.end();
+         next = pending.find(static_cast<int>(latencies.size()))) {
+      const JobResult& ready = next->second;
+      output << FormatResult(ready);
+      Clock::time_point written = Clock::now();
+      latencies.push_back(Milliseconds(ready.submitted, written));
+      log << "job " << ready.id << " (" << ready.description
+          << "): queued " << Milliseconds(ready.submitted, ready.computeStarted)
+          << " ms, computed "
+          << Milliseconds(ready.computeStarted, ready.computeFinished)
+          << " ms, latency " << latencies.back() << " ms"
+          << (ready.error.empty() ? "" : ", failed") << '\n';
+      if (!ready.error.empty()) {
+        ++failedJobs;
+      }
+      pending.erase(next);
+      tickets.push(0);
+    }
+  }
+  parser.join();
+  closer.join();
+  output.flush();
+
+  double elapsed = Milliseconds(started, Clock::now());
+  log << "batch: " << latencies.size() << " jobs in " << elapsed << " ms";
+  if (!latencies.empty()) {
+    std::vector<double> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double latency : sorted) {
+      total += latency;
+    }
+    log << ", " << sorted.size() * 1000.0 / std::max(elapsed, 1e-3)
+        << " jobs/s, latency mean " << total / sorted.size() << " ms, p50 "
+        << sorted[sorted.size() / 2] << " ms, p95 "
+        << sorted[sorted.size() * 95 / 100] << " ms, max " << sorted.back()
+        << " ms";
+  }
+  log << ", " << failedJobs << " failed\n";
+  return failedJobs;
+}
@@ -0,0 +1,20 @@
+#ifndef MATRIX_BATCHMODE_H
+#define MATRIX_BATCHMODE_H
+
+#include <iostream>
+
+// Runs a stream of jobs over Rational matrices through a parse -> compute ->
+// format pipeline. Every job is an operation name followed by its sizes and
+// operands, all separated by whitespace:
+//   multiply <m> <n> <p> <m x n matrix> <n x p matrix>
+//   determinant <n> <n x n matrix>
+//   inverse <n> <n x n matrix>
+//   power <n> <exponent> <n x n matrix>
+// Parsing and formatting are sequential, jobs are computed by workersNumber
+// threads, and results are written to output in submission order. Per-job
+// timings and a throughput summary go to log. Returns the number of jobs
+// which failed.
+int RunBatchMode(std::istream& input, std::ostream& output, std::ostream& log,
+                 int workersNumber);
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef MATRIX_BLOCKEDGAUSS_CPP
+#define MATRIX_BLOCKEDGAUSS_CPP
+
+#include <future>
+#include <vector>
+
+#include "Matrix.cpp"
+#include "OperationControl.h"
+#include "ThreadPool.h"
+
+// Matrices smaller than this are eliminated by the unblocked row-by-row code.
+const int kGaussBlockedThreshold = 128;
+const int kGaussBlockSize = 48;
+
+// Factorizes the panel of columns [first, last) over rows [first, size):
+// picks the first non-zero pivot of each column like GaussAlgorithm does,
+// swaps rows only inside the panel and stores the multipliers below the
+// diagonal. Returns false when the matrix turns out to be degenerate.
+template <typename T>
+bool FactorizePanel(T* const* rows, const int size, const int first,
+                    const int last, std::vector<int>& pivots,
+                    int& stringSwapsCounter) {
+  for (int c = first; c < last; ++c) {
+    int pivot = c;
+    while (pivot < size && rows[pivot][c] == getZero<T>()) {
+      ++pivot;
+    }
+    if (pivot == size) {
+      return false;
+    }
+    pivots[c] = pivot;
+    if (pivot != c) {
+      std::swap_ranges(rows[c] + first, rows[c] + last, rows[pivot] + first);
+      ++stringSwapsCounter;
+      MATRIX_COUNT(kPivotSwaps, 1);
+    }
+    for (int r = c + 1; r < size; ++r) {
+      if (rows[r][c] != getZero<T>()) {
+        T multiplier = rows[r][c] / rows[c][c];
+        rows[r][c] = multiplier;
+        MATRIX_COUNT(kMultiplications, last - c - 1);
+        MATRIX_COUNT(kAdditions, last - c - 1);
+        for (int j = c + 1; j < last; ++j) {
+          rows[r][j] -= multiplier * rows[c][j];
+        }
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void ApplyPivots(T* const* rows, const std::vector<int>& pivots,
+                 const int first, const int last, const int columnFirst,
+                 const int columnLast) {
+  for (int c = first; c < last; ++c) {
+    if (pivots[c] != c) {
+      std::swap_ranges(rows[c] + columnFirst, rows[c] + columnLast,
+                       rows[pivots[c]] + columnFirst);
+    }
+  }
+}
+
+// Brings the column tile [columnFirst, columnLast) up to date after the panel
+// [first, last) was factorized: applies the panel's row swaps, solves the
+// unit lower triangle of the panel for U12 and updates the trailing rows with
+// A22 -= L21 * U12 on the GEMM kernel.
+template <typename T>
+void UpdateTile(T* const* rows, const int size, const int first,
+                const int last, const std::vector<int>& pivots,
+                const int columnFirst, const int columnLast) {
+  ApplyPivots(rows, pivots, first, last, columnFirst, columnLast);
+  for (int c = first; c < last; ++c) {
+    MATRIX_COUNT(kMultiplications,
+                 static_cast<long long>(last - c - 1) *
+                     (columnLast - columnFirst));
+    MATRIX_COUNT(kAdditions, static_cast<long long>(last - c - 1) *
+                                 (columnLast - columnFirst));
+    for (int r = c + 1; r < last; ++r) {
+      const T multiplier = rows[r][c];
+      for (int j = columnFirst; j < columnLast; ++j) {
+        rows[r][j] -= multiplier * rows[c][j];
+      }
+    }
+  }
+  GemmKernel<T, true>(size - last, columnLast - columnFirst, last - first,
+                      rows + last, first, rows + first, columnFirst,
+                      rows + last, columnFirst);
+}
+
+// Right-looking blocked LU factorization in place: on success the upper
+// triangle holds U, the strict lower triangle holds the unit L multipliers
+// and pivots[c] is the row swapped with row c. Trailing updates of every
+// column tile run as pool tasks which depend on the previous update of the
+// same tile, and the next panel is factorized as soon as its own tile is
+// ready (lookahead) while the rest of the trailing matrix is still updating.
+// With a control every panel is one step, and once it is cancelled pending
+// tile updates are skipped and OperationCancelledError is thrown.
+template <typename T>
+bool BlockedLuFactorize(T* const* rows, const int size,
+                        std::vector<int>& pivots, int& stringSwapsCounter,
+                        OperationControl* control = nullptr) {
+  ThreadPool& pool = getMatrixThreadPool();
+  const int tilesNumber = (size + kGaussBlockSize - 1) / kGaussBlockSize;
+  std::vector<std::shared_future<void>> tileReady(tilesNumber);
+  pivots.assign(size, 0);
+
+  bool isFactorized = true;
+  for (int panel = 0; panel < tilesNumber; ++panel) {
+    const int first = panel * kGaussBlockSize;
+    const int last = std::min(size, first + kGaussBlockSize);
+    if (tileReady[panel].valid()) {
+      tileReady[panel].get();
+    }
+    if (control != nullptr && control->isCancelled()) {
+      break;
+    }
+    if (!FactorizePanel(rows, size, first, last, pivots, stringSwapsCounter)) {
+      isFactorized = false;
+      break;
+    }
+
+    for (int tile = panel + 1; tile < tilesNumber; ++tile) {
+      const int columnFirst = tile * kGaussBlockSize;
+      const int columnLast = std::min(size, columnFirst + kGaussBlockSize);
+      std::shared_future<void> previous = tileReady[tile];
+      tileReady[tile] =
+          pool.submit([rows, size, first, last, &pivots, columnFirst,
+                       columnLast, previous, control]() {
+                if (previous.valid()) {
+                  previous.get();
+                }
+                if (control != nullptr && control->isCancelled()) {
+                  return;
+                }
+                UpdateTile(rows, size, first, last, pivots, columnFirst,
+                           columnLast);
+              }).share();
+    }
+    if (control != nullptr) {
+      control->completeStep();
+    }
+  }
+
+  for (std::shared_future<void>& ready : tileReady) {
+    if (ready.valid()) {
+      ready.wait();
+    }
+  }
+  if (control != nullptr) {
+    control->ThrowIfCancelled();
+  }
+  // Swaps of later panels reach the columns of L only now: running tile
+  // updates read those columns, so they cannot be permuted earlier.
+  if (isFactorized) {
+    for (int first = kGaussBlockSize; first < size; first += kGaussBlockSize) {
+      ApplyPivots(rows, pivots, first, std::min(size, first + kGaussBlockSize),
+                  0, first);
+    }
+  }
+  return isFactorized;
+}
+
+// Overwrites the column tile [columnFirst, columnLast) of rhs with
+// U^-1 * L^-1 * rhs for the factors stored in lu. Off-diagonal blocks are
+// applied on the GEMM kernel, diagonal blocks by substitution.
+template <typename T>
+void SolveTile(const T* const* lu, T* const* rhs, const int size,
+               const int columnFirst, const int columnLast) {
+  const int width = columnLast - columnFirst;
+  for (int first = 0; first < size; first += kGaussBlockSize) {
+    const int last = std::min(size, first + kGaussBlockSize);
+    GemmKernel<T, true>(last - first, width, first, lu + first, 0, rhs,
+                        columnFirst, rhs + first, columnFirst);
+    MATRIX_COUNT(kMultiplications, static_cast<long long>(last - first) *
+                                       (last - first - 1) / 2 * width);
+    MATRIX_COUNT(kAdditions, static_cast<long long>(last - first) *
+                                 (last - first - 1) / 2 * width);
+    for (int r = first; r < last; ++r) {
+      for (int c = first; c < r; ++c) {
+        const T multiplier = lu[r][c];
+        for (int j = columnFirst; j < columnLast; ++j) {
+          rhs[r][j] -= multiplier * rhs[c][j];
+        }
+      }
+    }
+  }
+  for (int last = size; last > 0; last -= kGaussBlockSize) {
+    const int first = std::max(0, last - kGaussBlockSize);
+    GemmKernel<T, true>(last - first, width, size - last, lu + first, last,
+                        rhs + last, columnFirst, rhs + first, columnFirst);
+    MATRIX_COUNT(kMultiplications, static_cast<long long>(last - first) *
+                                       (last - first + 1) / 2 * width);
+    MATRIX_COUNT(kAdditions, static_cast<long long>(last - first) *
+                                 (last - first - 1) / 2 * width);
+    for (int r = last - 1; r >= first; --r) {
+      for (int c = r + 1; c < last; ++c) {
+        const T multiplier = lu[r][c];
+        for (int j = columnFirst; j < columnLast; ++j) {
+          rhs[r][j] -= multiplier * rhs[c][j];
+        }
+      }
+      const T diagonal = lu[r][r];
+      for (int j = columnFirst; j < columnLast; ++j) {
+        rhs[r][j] /= diagonal;
+      }
+    }
+  }
+}
+
+#endif
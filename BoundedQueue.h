@@ -0,0 +1,66 @@
+#ifndef MATRIX_BOUNDEDQUEUE_H
+#define MATRIX_BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// FIFO channel between pipeline stages. push() blocks while the queue is
+// full, so a fast producer can't run arbitrarily far ahead of its consumers.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(int capacity) : capacity_(capacity) {}
+
+  void push(T value);
+  // Returns false once the queue is closed and drained.
+  bool pop(T& value);
+  // No more values will be pushed; wakes up all waiting consumers.
+  void close();
+
+ private:
+  std::deque<T> values_;
+  const int capacity_;
+  bool isClosed_ = false;
+  std::mutex mutex_;
+  std::condition_variable notFull_;
+  std::condition_variable notEmpty_;
+};
+
+template <typename T>
+void BoundedQueue<T>::push(T value) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [this]() {
+      return static_cast<int>(values_.size()) < capacity_;
+    });
+    values_.push_back(std::move(value));
+  }
+  notEmpty_.notify_one();
+}
+
+template <typename T>
+bool BoundedQueue<T>::pop(T& value) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notEmpty_.wait(lock, [this]() { return isClosed_ || !values_.empty(); });
+    if (values_.empty()) {
+      return false;
+    }
+    value = std::move(values_.front());
+    values_.pop_front();
+  }
+  notFull_.notify_one();
+  return true;
+}
+
+template <typename T>
+void BoundedQueue<T>::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    isClosed_ = true;
+  }
+  notEmpty_.notify_all();
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "Instrumentation.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+std::mutex timingsMutex;
+std::map<std::string, Instrumentation::Timing>& getTimings() {
+  static std::map<std::string, Instrumentation::Timing> timings;
+  return timings;
+}
+
+void DumpAtExit() {
+  std::cerr << "Matrix instrumentation summary:\n";
+  Instrumentation::Dump(std::cerr, Instrumentation::TakeSnapshot());
+}
+
+}  // namespace
+
+std::atomic<long long> Instrumentation::counters_[kCountersNumber];
+
+bool Instrumentation::isEnabled() {
+#ifdef MATRIX_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+void Instrumentation::AddTiming(const char* name, const double milliseconds) {
+  std::lock_guard<std::mutex> lock(timingsMutex);
+  Timing& timing = getTimings()[name];
+  ++timing.calls;
+  timing.totalMs += milliseconds;
+}
+
+Instrumentation::Snapshot Instrumentation::TakeSnapshot() {
+  Snapshot snapshot;
+  for (int i = 0; i < kCountersNumber; ++i) {
+    snapshot.counters[i] = counters_[i].load(std::memory_order_relaxed);
+  }
+  std::lock_guard<std::mutex> lock(timingsMutex);
+  snapshot.timings = getTimings();
+  return snapshot;
+}
+
+void Instrumentation::Reset() {
+  for (int i = 0; i < kCountersNumber; ++i) {
+    counters_[i] = 0;
+  }
+  std::lock_guard<std::mutex> lock(timingsMutex);
+  getTimings().clear();
+}
+
+Instrumentation::Snapshot Instrumentation::Snapshot::operator-(
+    const Snapshot& earlier) const {
+  Snapshot difference(*this);
+  for (int i = 0; i < kCountersNumber; ++i) {
+    difference.counters[i] -= earlier.counters[i];
+  }
+  for (const auto& timing : earlier.timings) {
+    Timing& current = difference.timings[timing.first];
+    current.calls -= timing.second.calls;
+    current.totalMs -= timing.second.totalMs;
+    if (current.calls == 0) {
+      difference.timings.erase(timing.first);
+    }
+  }
+  return difference;
+}
+
+const char* Instrumentation::getCounterName(const Counter counter) {
+  switch (counter) {
+    case Counter::kAllocations:
+      return "heap allocations";
+    case Counter::kAllocatedBytes:
+      return "allocated bytes";
+    case Counter::kMultiplications:
+      return "scalar multiplications";
+    case Counter::kAdditions:
+      return "scalar additions";
+    case Counter::kRationalReductions:
+      return "Rational reductions";
+    case Counter::kPivotSwaps:
+      return "pivot row swaps";
+    case Counter::kDeepCopies:
+      return "deep matrix copies";
+    case Counter::kCountersNumber:
+      break;
+  }
+  return "unknown";
+}
+
+void Instrumentation::Dump(std::ostream& os, const Snapshot& snapshot) {
+  if (!isEnabled()) {
+    os << "  instrumentation is disabled, build with MATRIX_INSTRUMENTATION\n";
+    return;
+  }
+  for (int i = 0; i < kCountersNumber; ++i) {
+    os << "  " << getCounterName(static_cast<Counter>(i)) << ": "
+       << snapshot.counters[i] << '\n';
+  }
+  for (const auto& timing : snapshot.timings) {
+    os << "  " << timing.first << ": " << timing.second.calls << " calls, "
+       << timing.second.totalMs << " ms\n";
+  }
+}
+
+void Instrumentation::InstallExitSummary() {
+  const char* value = std::getenv("MATRIX_INSTRUMENTATION_SUMMARY");
+  if (value != nullptr && *value != '\0' && std::strcmp(value, "0") != 0) {
+    // Touch the timings so they outlive the handler registered after them.
+    getTimings();
+    std::atexit(DumpAtExit);
+  }
+}
@@ -0,0 +1,94 @@
+#ifndef MATRIX_INSTRUMENTATION_H
+#define MATRIX_INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Counters and timings of the hot paths. They are collected only when the
+// tree is built with MATRIX_INSTRUMENTATION defined (the CMake option of the
+// same name): otherwise MATRIX_COUNT and MATRIX_SCOPED_TIMER expand to
+// nothing and snapshots stay empty.
+class Instrumentation {
+ public:
+  enum class Counter {
+    kAllocations,
+    kAllocatedBytes,
+    kMultiplications,
+    kAdditions,
+    kRationalReductions,
+    kPivotSwaps,
+    kDeepCopies,
+    kCountersNumber
+  };
+  static const int kCountersNumber =
+      static_cast<int>(Counter::kCountersNumber);
+
+  struct Timing {
+    long long calls = 0;
+    double totalMs = 0;
+  };
+
+  // Counter values and timings at some moment. The difference of two
+  // snapshots taken around an operation gives the cost of that operation.
+  struct Snapshot {
+    long long counters[kCountersNumber] = {};
+    std::map<std::string, Timing> timings;
+
+    long long operator[](Counter counter) const {
+      return counters[static_cast<int>(counter)];
+    }
+    Snapshot operator-(const Snapshot& earlier) const;
+  };
+
+  static bool isEnabled();
+  static void Add(const Counter counter, const long long amount) {
+    counters_[static_cast<int>(counter)].fetch_add(amount,
+                                                   std::memory_order_relaxed);
+  }
+  static void AddTiming(const char* name, double milliseconds);
+
+  static Snapshot TakeSnapshot();
+  static void Reset();
+  static void Dump(std::ostream& os, const Snapshot& snapshot);
+  static const char* getCounterName(Counter counter);
+
+  // Prints the summary to stderr at exit if the MATRIX_INSTRUMENTATION_SUMMARY
+  // environment variable is set to a non-empty value other than 0.
+  static void InstallExitSummary();
+
+ private:
+  static std::atomic<long long> counters_[kCountersNumber];
+};
+
+// Adds the wall-clock time of the enclosing scope to the timing called name.
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(const char* name)
+      : name_(name), started_(std::chrono::steady_clock::now()) {}
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+  ~ScopedTimer() {
+    Instrumentation::AddTiming(
+        name_, std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - started_)
+                   .count());
+  }
+
+ private:
+  const char* name_;
+  std::chrono::steady_clock::time_point started_;
+};
+
+#ifdef MATRIX_INSTRUMENTATION
+#define MATRIX_COUNT(counter, amount) \
+  Instrumentation::Add(Instrumentation::Counter::counter, (amount))
+#define MATRIX_SCOPED_TIMER(name) ScopedTimer matrixScopedTimer(name)
+#else
+#define MATRIX_COUNT(counter, amount) static_cast<void>(0)
+#define MATRIX_SCOPED_TIMER(name) static_cast<void>(0)
+#endif
+
+#endif
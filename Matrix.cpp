@@ -1,6 +1,12 @@
+#ifndef MATRIX_MATRIX_CPP
+#define MATRIX_MATRIX_CPP
+
+#include <algorithm>
 #include <exception>
 #include <iostream>
 
+#include "Instrumentation.h"
+
 template <typename T>
 T getZero() {
   return T(0);
@@ -23,6 +29,13 @@ class MatrixIndexError : public std::exception {
   }
 };
 
+class OperationControl;
+
+template <typename T>
+class SymmetricMatrix;
+template <typename T>
+class TriangularMatrix;
+
 template <typename T>
 class Matrix {
  public:
@@ -63,6 +76,24 @@ class Matrix {
     return *this = (*this * number);
   }
 
+  template <typename M>
+  friend Matrix<M> operator*(const TriangularMatrix<M>& lmx,
+                             const Matrix<M>& rmx);
+  template <typename M>
+  friend Matrix<M> operator*(const Matrix<M>& lmx,
+                             const TriangularMatrix<M>& rmx);
+  template <typename M>
+  friend Matrix<M> SolveTriangular(const TriangularMatrix<M>& matrix,
+                                   const Matrix<M>& rhs);
+  template <typename M>
+  friend Matrix<M> MultiplyByBlocks(const Matrix<M>& lmx, const Matrix<M>& rmx,
+                                    OperationControl& control);
+  template <typename M>
+  friend SymmetricMatrix<M> MultiplyByTransposed(const Matrix<M>& matrix);
+  template <typename M>
+  friend Matrix<M> operator*(const SymmetricMatrix<M>& lmx,
+                             const Matrix<M>& rmx);
+
   T& operator()(int positionHeight, int positionWidth);
   T operator()(int positionHeight, int positionWidth) const;
 
@@ -79,20 +110,32 @@ class Matrix {
   }
 
  protected:
+  // Allocates the rows of a height x width field, counting the allocations.
+  static T** AllocateField(int height, int width);
+
   int height_ = 0;
-  T** matrixField_;
+  T** matrixField_ = nullptr;
 
   int width_ = 0;
 };
 
+template <typename T>
+T** Matrix<T>::AllocateField(const int height, const int width) {
+  MATRIX_COUNT(kAllocations, height + 1);
+  MATRIX_COUNT(kAllocatedBytes, static_cast<long long>(height) *
+                                    (sizeof(T*) + width * sizeof(T)));
+  T** field = new T*[height];
+  for (int i = 0; i < height; ++i) {
+    field[i] = new T[width];
+  }
+  return field;
+}
+
 template <typename T>
 Matrix<T>::Matrix(const int height, const int width) {
   height_ = height;
   width_ = width;
-  matrixField_ = new T*[height];
-  for (int i = 0; i < height_; ++i) {
-    matrixField_[i] = new T[width];
-  }
+  matrixField_ = AllocateField(height_, width_);
   for (int i = 0; i < height_; ++i) {
     for (int j = 0; j < width_; ++j) {
       matrixField_[i][j] = 0;
@@ -104,10 +147,8 @@ template <typename T>
 Matrix<T>::Matrix(const Matrix<T>& other) {
   width_ = other.width_;
   height_ = other.height_;
-  matrixField_ = new T*[height_];
-  for (int i = 0; i < height_; ++i) {
-    matrixField_[i] = new T[width_];
-  }
+  MATRIX_COUNT(kDeepCopies, 1);
+  matrixField_ = AllocateField(height_, width_);
   for (int i = 0; i < height_; ++i) {
     for (int j = 0; j < width_; ++j) {
       matrixField_[i][j] = other.matrixField_[i][j];
@@ -117,8 +158,8 @@ Matrix<T>::Matrix(const Matrix<T>& other) {
 template <typename T>
 Matrix<T>::Matrix(Matrix<T>&& other) noexcept {
   std::swap(matrixField_, other.matrixField_);
-  width_ = other.width_;
-  height_ = other.height_;
+  std::swap(width_, other.width_);
+  std::swap(height_, other.height_);
 }
 
 template <typename T>
@@ -127,10 +168,8 @@ Matrix<T>& Matrix<T>::operator=(const Matrix<T>& other) {
     this->ClearMatrix();
     width_ = other.width_;
     height_ = other.height_;
-    this->matrixField_ = new T*[height_];
-    for (int i = 0; i < height_; ++i) {
-      matrixField_[i] = new T[width_];
-    }
+    MATRIX_COUNT(kDeepCopies, 1);
+    matrixField_ = AllocateField(height_, width_);
     for (int i = 0; i < height_; ++i) {
       for (int j = 0; j < width_; ++j) {
         matrixField_[i][j] = other.matrixField_[i][j];
@@ -142,8 +181,8 @@ Matrix<T>& Matrix<T>::operator=(const Matrix<T>& other) {
 template <typename T>
 Matrix<T>& Matrix<T>::operator=(Matrix<T>&& other) noexcept {
   if (other.matrixField_ != this->matrixField_) {
-    width_ = other.width_;
-    height_ = other.height_;
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
     std::swap(matrixField_, other.matrixField_);
   }
   return *this;
@@ -157,11 +196,51 @@ Matrix<T>::~Matrix() {
   delete[] matrixField_;
 }
 
+const int kGemmRowsBlock = 64;
+const int kGemmColumnsBlock = 256;
+
+// C += A * B (or C -= A * B when Subtract is set) on row-pointer storage
+// without bounds checks. A is m x k starting at column aColumn of aRows, B is
+// k x n starting at column bColumn of bRows, C is m x n starting at column
+// cColumn of cRows. The loops are blocked so the current panel of B stays in
+// cache while the innermost loop runs over contiguous row segments.
+template <typename T, bool Subtract>
+void GemmKernel(const int m, const int n, const int k,
+                const T* const* aRows, const int aColumn,
+                const T* const* bRows, const int bColumn, T* const* cRows,
+                const int cColumn) {
+  MATRIX_COUNT(kMultiplications, static_cast<long long>(m) * n * k);
+  MATRIX_COUNT(kAdditions, static_cast<long long>(m) * n * k);
+  for (int jBlock = 0; jBlock < n; jBlock += kGemmColumnsBlock) {
+    int jEnd = std::min(n, jBlock + kGemmColumnsBlock);
+    for (int lBlock = 0; lBlock < k; lBlock += kGemmRowsBlock) {
+      int lEnd = std::min(k, lBlock + kGemmRowsBlock);
+      for (int i = 0; i < m; ++i) {
+        const T* aRow = aRows[i] + aColumn;
+        T* cRow = cRows[i] + cColumn;
+        for (int l = lBlock; l < lEnd; ++l) {
+          const T a = aRow[l];
+          const T* bRow = bRows[l] + bColumn;
+          for (int j = jBlock; j < jEnd; ++j) {
+            if (Subtract) {
+              cRow[j] -= a * bRow[j];
+            } else {
+              cRow[j] += a * bRow[j];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 template <typename T>
 Matrix<T> operator+(const Matrix<T>& lmx, const Matrix<T>& rmx) {
   if (lmx.width_ != rmx.width_ || lmx.height_ != rmx.height_) {
     throw MatrixWrongSizeError();
   }
+  MATRIX_SCOPED_TIMER("Matrix add");
+  MATRIX_COUNT(kAdditions, static_cast<long long>(lmx.height_) * lmx.width_);
   Matrix<T> newMatrix(lmx.height_, lmx.width_);
   for (int i = 0; i < newMatrix.height_; ++i) {
     for (int j = 0; j < newMatrix.width_; ++j) {
@@ -176,6 +255,8 @@ Matrix<T> operator-(const Matrix<T>& lmx, const Matrix<T>& rmx) {
   if (lmx.width_ != rmx.width_ || lmx.height_ != rmx.height_) {
     throw MatrixWrongSizeError();
   }
+  MATRIX_SCOPED_TIMER("Matrix subtract");
+  MATRIX_COUNT(kAdditions, static_cast<long long>(lmx.height_) * lmx.width_);
   Matrix<T> newMatrix(lmx.height_, lmx.width_);
   for (int i = 0; i < newMatrix.height_; ++i) {
     for (int j = 0; j < newMatrix.width_; ++j) {
@@ -187,6 +268,8 @@ Matrix<T> operator-(const Matrix<T>& lmx, const Matrix<T>& rmx) {
 }
 template <typename T, typename U>
 Matrix<T> operator*(const U& scalar, const Matrix<T>& lmx) {
+  MATRIX_COUNT(kMultiplications,
+               static_cast<long long>(lmx.height_) * lmx.width_);
   Matrix<T> newMatrix(lmx.height_, lmx.width_);
   for (int i = 0; i < newMatrix.height_; ++i) {
     for (int j = 0; j < newMatrix.width_; ++j) {
@@ -198,6 +281,8 @@ Matrix<T> operator*(const U& scalar, const Matrix<T>& lmx) {
 
 template <typename T, typename U>
 Matrix<T> operator*(const Matrix<T>& lmx, const U& scalar) {
+  MATRIX_COUNT(kMultiplications,
+               static_cast<long long>(lmx.height_) * lmx.width_);
   Matrix<T> newMatrix(lmx.height_, lmx.width_);
   for (int i = 0; i < newMatrix.height_; ++i) {
     for (int j = 0; j < newMatrix.width_; ++j) {
@@ -211,15 +296,10 @@ Matrix<T> operator*(const Matrix<T>& lmx, const Matrix<T>& rmx) {
   if (lmx.width_ != rmx.height_) {
     throw MatrixWrongSizeError();
   }
+  MATRIX_SCOPED_TIMER("Matrix multiply");
   Matrix<T> newMatrix(lmx.height_, rmx.width_);
-  for (int i = 0; i < lmx.height_; ++i) {
-    for (int j = 0; j < rmx.width_; ++j) {
-      for (int k = 0; k < lmx.width_; ++k) {
-        newMatrix.matrixField_[i][j] +=
-            lmx.matrixField_[i][k] * rmx.matrixField_[k][j];
-      }
-    }
-  }
+  GemmKernel<T, false>(lmx.height_, rmx.width_, lmx.width_, lmx.matrixField_,
+                       0, rmx.matrixField_, 0, newMatrix.matrixField_, 0);
   return newMatrix;
 }
 
@@ -243,10 +323,9 @@ T Matrix<T>::operator()(const int positionHeight,
 
 template <typename T>
 std::istream& operator>>(std::istream& is, Matrix<T>& matrix) {
-  matrix.matrixField_ = new T*[matrix.height_];
-  for (int i = 0; i < matrix.height_; ++i) {
-    matrix.matrixField_[i] = new T[matrix.width_];
-  }
+  matrix.ClearMatrix();
+  matrix.matrixField_ =
+      Matrix<T>::AllocateField(matrix.height_, matrix.width_);
 
   for (int i = 0; i < matrix.height_; ++i) {
     for (int j = 0; j < matrix.width_; ++j) {
@@ -268,6 +347,7 @@ std::ostream& operator<<(std::ostream& os, const Matrix<T>& matrix) {
 
 template <typename T>
 Matrix<T> Matrix<T>::getTransposed() {
+  MATRIX_SCOPED_TIMER("Matrix transpose");
   Matrix<T> newMatrix(width_, height_);
   for (int i = 0; i < height_; ++i) {
     for (int j = 0; j < width_; ++j) {
@@ -287,3 +367,5 @@ Matrix<T>& Matrix<T>::Transpose() {
   *this = newMatrix;
   return *this;
 }
+
+#endif
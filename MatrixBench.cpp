@@ -0,0 +1,368 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Rational.h"
+#include "SquareMatrix.cpp"
+
+// Every heap allocation of the benchmark goes through these counters, so the
+// allocations of an operation are the difference around its runs.
+namespace {
+std::atomic<long long> allocationsNumber{0};
+std::atomic<long long> allocatedBytes{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocationsNumber;
+  allocatedBytes += size;
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::vector<int> sizes = {16, 64, 256};
+  std::vector<std::string> types = {"rational", "double", "longlong"};
+  double minTimeMs = 200;
+  std::string format = "csv";
+  std::string output;
+  std::string baseline;
+  double threshold = 0.1;
+};
+
+struct Measurement {
+  std::string operation;
+  std::string type;
+  int size = 0;
+  int iterations = 0;
+  double nsPerOp = 0;
+  double gflops = 0;
+  double allocationsPerOp = 0;
+  double bytesPerOp = 0;
+  std::string error;
+
+  std::string getKey() const {
+    return operation + ',' + type + ',' + std::to_string(size);
+  }
+};
+
+// Keeps the compiler from dropping a computation whose result is unused:
+// the empty asm takes the address of the value and clobbers memory, so the
+// value has to be fully stored before it.
+template <typename T>
+void Consume(const T& value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Runs op until minTimeMs passes (at least once) and fills the averages.
+Measurement Measure(const std::string& operation, const std::string& type,
+                    const int size, const double flopsPerOp,
+                    const double minTimeMs, const std::function<void()>& op) {
+  Measurement measurement;
+  measurement.operation = operation;
+  measurement.type = type;
+  measurement.size = size;
+  long long allocationsBefore = allocationsNumber;
+  long long bytesBefore = allocatedBytes;
+  Clock::time_point started = Clock::now();
+  double elapsedMs = 0;
+  try {
+    do {
+      op();
+      ++measurement.iterations;
+      elapsedMs =
+          std::chrono::duration<double, std::milli>(Clock::now() - started)
+              .count();
+    } while (elapsedMs < minTimeMs);
+  } catch (const std::exception& error) {
+    measurement.error = error.what();
+    return measurement;
+  }
+  measurement.nsPerOp = elapsedMs * 1e6 / measurement.iterations;
+  measurement.gflops = flopsPerOp / measurement.nsPerOp;
+  measurement.allocationsPerOp =
+      static_cast<double>(allocationsNumber - allocationsBefore) /
+      measurement.iterations;
+  measurement.bytesPerOp =
+      static_cast<double>(allocatedBytes - bytesBefore) /
+      measurement.iterations;
+  return measurement;
+}
+
+// Dense matrix L * U with L = [[I, 0], [E, I]] and U = [[I, F], [0, I]] for
+// random small E and F. Its elimination and inverse [[I + F * E, -F], [-E, I]]
+// stay in small integers, so Rational doesn't overflow and long long division
+// is exact at any size.
+template <typename T>
+SquareMatrix<T> RandomMatrix(const int size, std::mt19937& random) {
+  int half = size / 2;
+  Matrix<T> lower(size - half, half);
+  Matrix<T> upper(half, size - half);
+  for (int i = 0; i < size - half; ++i) {
+    for (int j = 0; j < half; ++j) {
+      lower(i, j) = T(static_cast<long long>(random() % 7) - 3);
+      upper(j, i) = T(static_cast<long long>(random() % 7) - 3);
+    }
+  }
+  Matrix<T> product = lower * upper;
+  SquareMatrix<T> matrix(size);
+  for (int i = 0; i < size; ++i) {
+    matrix(i, i) = getOne<T>();
+  }
+  for (int i = 0; i < size - half; ++i) {
+    for (int j = 0; j < half; ++j) {
+      matrix(half + i, j) = lower(i, j);
+      matrix(j, half + i) = upper(j, i);
+    }
+    for (int j = 0; j < size - half; ++j) {
+      matrix(half + i, half + j) += product(i, j);
+    }
+  }
+  return matrix;
+}
+
+template <typename T>
+void RunSuite(const std::string& type, const Options& options,
+              std::vector<Measurement>& measurements) {
+  std::mt19937 random(42);
+  for (int size : options.sizes) {
+    const double n = size;
+    SquareMatrix<T> lmx = RandomMatrix<T>(size, random);
+    SquareMatrix<T> rmx = RandomMatrix<T>(size, random);
+    const Matrix<T>& a = lmx;
+    const Matrix<T>& b = rmx;
+    auto measure = [&](const std::string& operation, const double flops,
+                       const std::function<void()>& op) {
+      measurements.push_back(
+          Measure(operation, type, size, flops, options.minTimeMs, op));
+    };
+
+    measure("multiply", 2 * n * n * n, [&]() { Consume(a * b); });
+    measure("add", n * n, [&]() { Consume(a + b); });
+    measure("transpose", 0, [&]() { Consume(lmx.getTransposed()); });
+    measure("determinant", 2 * n * n * n / 3,
+            [&]() { Consume(lmx.getDeterminant()); });
+    measure("inverse", 2 * n * n * n,
+            [&]() { Consume(lmx.getInverse()); });
+
+    std::stringstream text;
+    text << a;
+    std::string written = text.str();
+    measure("write", 0, [&]() {
+      std::ostringstream os;
+      os << a;
+      Consume(os);
+    });
+    measure("read", 0, [&]() {
+      std::istringstream is(written);
+      Matrix<T> c(size, size);
+      is >> c;
+      Consume(c);
+    });
+  }
+}
+
+// Rational arithmetic on its own: size is the length of the vectors whose
+// dot product and sum are computed, each element costing four operations.
+void RunRationalArithmetic(const Options& options,
+                           std::vector<Measurement>& measurements) {
+  std::mt19937 random(7);
+  for (int size : options.sizes) {
+    std::vector<Rational> lhs;
+    std::vector<Rational> rhs;
+    for (int i = 0; i < size; ++i) {
+      lhs.emplace_back(random() % 19 + 1, random() % 7 + 1);
+      rhs.emplace_back(random() % 23 + 1, random() % 5 + 1);
+    }
+    measurements.push_back(Measure(
+        "rational_arithmetic", "rational", size, 4.0 * size,
+        options.minTimeMs, [&]() {
+          Rational dot;
+          Rational sum;
+          for (int i = 0; i < size; ++i) {
+            dot += lhs[i] * rhs[i];
+            sum = sum + lhs[i] / rhs[i];
+          }
+          Consume(dot);
+          Consume(sum);
+        }));
+  }
+}
+
+void WriteCsv(std::ostream& os, const std::vector<Measurement>& measurements) {
+  os << "operation,type,size,iterations,ns_per_op,gflops,allocations_per_op,"
+        "bytes_per_op,error\n";
+  for (const Measurement& m : measurements) {
+    os << m.operation << ',' << m.type << ',' << m.size << ',' << m.iterations
+       << ',' << m.nsPerOp << ',' << m.gflops << ',' << m.allocationsPerOp
+       << ',' << m.bytesPerOp << ',' << m.error << '\n';
+  }
+}
+
+void WriteJson(std::ostream& os, const std::vector<Measurement>& measurements) {
+  os << "[\n";
+  for (size_t i = 0; i < measurements.size(); ++i) {
+    const Measurement& m = measurements[i];
+    os << "  {\"operation\": \"" << m.operation << "\", \"type\": \""
+       << m.type << "\", \"size\": " << m.size
+       << ", \"iterations\": " << m.iterations
+       << ", \"ns_per_op\": " << m.nsPerOp << ", \"gflops\": " << m.gflops
+       << ", \"allocations_per_op\": " << m.allocationsPerOp
+       << ", \"bytes_per_op\": " << m.bytesPerOp << ", \"error\": \""
+       << m.error << "\"}" << (i + 1 < measurements.size() ? "," : "")
+       << '\n';
+  }
+  os << "]\n";
+}
+
+// Reads ns_per_op of every row of a CSV written by WriteCsv.
+std::map<std::string, double> ReadBaseline(std::istream& is) {
+  std::map<std::string, double> baseline;
+  std::string line;
+  std::getline(is, line);
+  while (std::getline(is, line)) {
+    std::vector<std::string> fields;
+    std::stringstream row(line);
+    std::string field;
+    while (std::getline(row, field, ',')) {
+      fields.push_back(field);
+    }
+    if (fields.size() >= 5) {
+      baseline[fields[0] + ',' + fields[1] + ',' + fields[2]] =
+          std::atof(fields[4].c_str());
+    }
+  }
+  return baseline;
+}
+
+std::vector<std::string> Split(const std::string& text) {
+  std::vector<std::string> parts;
+  std::stringstream stream(text);
+  std::string part;
+  while (std::getline(stream, part, ',')) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+bool ParseOptions(const int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string name = argv[i];
+    if (i + 1 >= argc) {
+      return false;
+    }
+    std::string value = argv[++i];
+    if (name == "--sizes") {
+      options.sizes.clear();
+      for (const std::string& size : Split(value)) {
+        options.sizes.push_back(std::atoi(size.c_str()));
+      }
+    } else if (name == "--types") {
+      options.types = Split(value);
+    } else if (name == "--min-time-ms") {
+      options.minTimeMs = std::atof(value.c_str());
+    } else if (name == "--format") {
+      options.format = value;
+    } else if (name == "--output") {
+      options.output = value;
+    } else if (name == "--baseline") {
+      options.baseline = value;
+    } else if (name == "--threshold") {
+      options.threshold = std::atof(value.c_str());
+    } else {
+      return false;
+    }
+  }
+  return options.format == "csv" || options.format == "json";
+}
+
+}  // namespace
+
+// Usage: matrix_bench [--sizes 16,64,256] [--types rational,double,longlong]
+//                     [--min-time-ms 200] [--format csv|json] [--output file]
+//                     [--baseline file.csv] [--threshold 0.1]
+// Prints the measurements (or writes them to --output). With --baseline
+// every operation slower than the baseline by more than the threshold is
+// reported to stderr and the exit code is 1.
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    std::cerr << "Usage: matrix_bench [--sizes 16,64,256] "
+                 "[--types rational,double,longlong] [--min-time-ms 200] "
+                 "[--format csv|json] [--output file] [--baseline file.csv] "
+                 "[--threshold 0.1]\n";
+    return 2;
+  }
+
+  std::vector<Measurement> measurements;
+  for (const std::string& type : options.types) {
+    if (type == "rational") {
+      RunSuite<Rational>(type, options, measurements);
+      RunRationalArithmetic(options, measurements);
+    } else if (type == "double") {
+      RunSuite<double>(type, options, measurements);
+    } else if (type == "longlong") {
+      RunSuite<long long>(type, options, measurements);
+    } else {
+      std::cerr << "Unknown element type " << type << '\n';
+      return 2;
+    }
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+  }
+  std::ostream& os = options.output.empty() ? std::cout : file;
+  if (options.format == "json") {
+    WriteJson(os, measurements);
+  } else {
+    WriteCsv(os, measurements);
+  }
+
+  if (options.baseline.empty()) {
+    return 0;
+  }
+  std::ifstream baselineFile(options.baseline);
+  if (!baselineFile) {
+    std::cerr << "Cannot open baseline " << options.baseline << '\n';
+    return 2;
+  }
+  std::map<std::string, double> baseline = ReadBaseline(baselineFile);
+  int regressions = 0;
+  for (const Measurement& m : measurements) {
+    auto previous = baseline.find(m.getKey());
+    if (previous == baseline.end() || previous->second <= 0 ||
+        !m.error.empty()) {
+      continue;
+    }
+    double ratio = m.nsPerOp / previous->second;
+    if (ratio > 1 + options.threshold) {
+      ++regressions;
+      std::cerr << "REGRESSION " << m.getKey() << ": " << m.nsPerOp
+                << " ns/op vs baseline " << previous->second << " ns/op (+"
+                << (ratio - 1) * 100 << "%)\n";
+    }
+  }
+  std::cerr << regressions << " regressions above " << options.threshold * 100
+            << "%\n";
+  return regressions == 0 ? 0 : 1;
+}
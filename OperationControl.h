@@ -0,0 +1,53 @@
+#ifndef MATRIX_OPERATIONCONTROL_H
+#define MATRIX_OPERATIONCONTROL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <utility>
+
+class OperationCancelledError : public std::exception {
+  const char* what() const noexcept override {
+    return "Operation was cancelled before it finished";
+  }
+};
+
+// Shared state of a long-running operation. The caller may cancel it at any
+// moment; the algorithm checks isCancelled() between its blocks and reports
+// every finished block with completeStep().
+class OperationControl {
+ public:
+  OperationControl() = default;
+  // onProgress is called with the fraction of finished steps, possibly from
+  // several worker threads at once.
+  explicit OperationControl(std::function<void(double)> onProgress)
+      : onProgress_(std::move(onProgress)) {}
+
+  void cancel() { isCancelled_ = true; }
+  bool isCancelled() const { return isCancelled_; }
+  void ThrowIfCancelled() const {
+    if (isCancelled_) {
+      throw OperationCancelledError();
+    }
+  }
+
+  void setTotalSteps(const int steps) { totalSteps_ = std::max(1, steps); }
+  void completeStep() {
+    ++completedSteps_;
+    if (onProgress_) {
+      onProgress_(getProgress());
+    }
+  }
+  double getProgress() const {
+    return std::min(1.0, static_cast<double>(completedSteps_) / totalSteps_);
+  }
+
+ private:
+  std::atomic<bool> isCancelled_{false};
+  std::atomic<int> totalSteps_{1};
+  std::atomic<int> completedSteps_{0};
+  std::function<void(double)> onProgress_;
+};
+
+#endif
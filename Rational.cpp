@@ -1,6 +1,11 @@
 #include "Rational.h"
 
+#include <cstdlib>
+
+#include "Instrumentation.h"
+
 void Rational::reduce() {
+  MATRIX_COUNT(kRationalReductions, 1);
   if (q_ < 0) {
     q_ *= -1;
     p_ *= -1;
@@ -8,12 +13,12 @@ void Rational::reduce() {
   if (p_ == 0) {
     q_ = 1;
   }
-  int reduceNumber = gcd(abs(p_), abs(q_));
+  long long reduceNumber = gcd(std::llabs(p_), std::llabs(q_));
   p_ /= reduceNumber;
   q_ /= reduceNumber;
 }
 
-int Rational::gcd(int a, int b) {
+long long Rational::gcd(long long a, long long b) {
   while (a > 0 && b > 0) {
     if (a > b) {
       a = a % b;
@@ -25,8 +30,12 @@ int Rational::gcd(int a, int b) {
 }
 
 std::istream& operator>>(std::istream& is, Rational& number) {
-  int read = scanf("%lld/%lld", &number.p_, &number.q_);
-  if (number.q_ == 0 || number.p_ == 0 || read < 2) {
+  number.q_ = 1;
+  if (is >> number.p_ && is.peek() == '/') {
+    is.get();
+    is >> number.q_;
+  }
+  if (number.q_ == 0 || number.p_ == 0) {
     number.q_ = 1;
   }
   number.reduce();
@@ -34,11 +43,11 @@ std::istream& operator>>(std::istream& is, Rational& number) {
 }
 std::ostream& operator<<(std::ostream& os, const Rational& number) {
   if (number.p_ == 0) {
-    std::cout << 0;
+    os << 0;
   } else if (number.q_ != 1) {
-    std::cout << number.p_ << '/' << number.q_;
+    os << number.p_ << '/' << number.q_;
   } else {
-    std::cout << number.p_;
+    os << number.p_;
   }
   return os;
 }
@@ -15,7 +15,7 @@ class Rational {
   Rational(const long long p, const long long q) : p_(p), q_(q) {
     this->reduce();
   }
-  explicit Rational(const long long p) : p_(p), q_(1) {}
+  Rational(const long long p) : p_(p), q_(1) {}
   Rational() : p_(0), q_(1) {}
 
   long long getNumerator() const { return p_; }
@@ -49,10 +49,11 @@ class Rational {
   Rational& operator*=(const Rational& number);
   Rational& operator/=(const Rational& number);
 
+  static long long gcd(long long a, long long b);
+
  private:
   long long p_, q_;
 
-  static int gcd(int a, int b);
   void reduce();
 };
 
@@ -0,0 +1,313 @@
+#include "ScaledIntegerMatrix.h"
+
+#include <climits>
+#include <cstdlib>
+
+namespace {
+
+const long double kLongLongLimit = 9.2e18L;
+
+long long Narrow(const __int128 value) {
+  if (value > static_cast<__int128>(LLONG_MAX) ||
+      value < static_cast<__int128>(LLONG_MIN)) {
+    throw IntegerOverflowError();
+  }
+  return static_cast<long long>(value);
+}
+
+long long Lcm(const long long a, const long long b) {
+  return Narrow(static_cast<__int128>(a / Rational::gcd(a, b)) * b);
+}
+
+}  // namespace
+
+ScaledIntegerMatrix::ScaledIntegerMatrix(const int height, const int width)
+    : height_(height),
+      width_(width),
+      numerators_(height * width, 0),
+      denominators_(height, 1) {}
+
+ScaledIntegerMatrix::ScaledIntegerMatrix(const Matrix<Rational>& matrix,
+                                         const DenominatorScope scope)
+    : ScaledIntegerMatrix(matrix.getRowsNumber(), matrix.getColumnsNumber()) {
+  for (int i = 0; i < height_; ++i) {
+    for (int j = 0; j < width_; ++j) {
+      denominators_[i] =
+          Lcm(denominators_[i], matrix(i, j).getDenominator());
+    }
+  }
+  if (scope == DenominatorScope::kMatrix) {
+    UnifyDenominators();
+  }
+  for (int i = 0; i < height_; ++i) {
+    for (int j = 0; j < width_; ++j) {
+      Rational element = matrix(i, j);
+      row(i)[j] = Narrow(static_cast<__int128>(element.getNumerator()) *
+                         (denominators_[i] / element.getDenominator()));
+    }
+  }
+}
+
+long long ScaledIntegerMatrix::getNumerator(const int positionHeight,
+                                            const int positionWidth) const {
+  if (positionHeight < 0 || positionHeight >= height_ || positionWidth < 0 ||
+      positionWidth >= width_) {
+    throw MatrixIndexError();
+  }
+  return row(positionHeight)[positionWidth];
+}
+long long ScaledIntegerMatrix::getDenominator(const int positionHeight) const {
+  if (positionHeight < 0 || positionHeight >= height_) {
+    throw MatrixIndexError();
+  }
+  return denominators_[positionHeight];
+}
+Rational ScaledIntegerMatrix::operator()(const int positionHeight,
+                                         const int positionWidth) const {
+  return Rational(getNumerator(positionHeight, positionWidth),
+                  denominators_[positionHeight]);
+}
+
+Matrix<Rational> ScaledIntegerMatrix::getRationalMatrix() const {
+  Matrix<Rational> matrix(height_, width_);
+  for (int i = 0; i < height_; ++i) {
+    for (int j = 0; j < width_; ++j) {
+      matrix(i, j) = Rational(row(i)[j], denominators_[i]);
+    }
+  }
+  return matrix;
+}
+
+long long ScaledIntegerMatrix::getMaxAbsNumerator() const {
+  long long maxAbs = 0;
+  for (long long numerator : numerators_) {
+    maxAbs = std::max(maxAbs, std::llabs(numerator));
+  }
+  return maxAbs;
+}
+
+void ScaledIntegerMatrix::ReduceRows() {
+  for (int i = 0; i < height_; ++i) {
+    long long divisor = denominators_[i];
+    for (int j = 0; j < width_ && divisor > 1; ++j) {
+      divisor = Rational::gcd(divisor, std::llabs(row(i)[j]));
+    }
+    if (divisor > 1) {
+      for (int j = 0; j < width_; ++j) {
+        row(i)[j] /= divisor;
+      }
+      denominators_[i] /= divisor;
+    }
+  }
+}
+
+void ScaledIntegerMatrix::UnifyDenominators() {
+  long long common = 1;
+  for (long long denominator : denominators_) {
+    common = Lcm(common, denominator);
+  }
+  for (int i = 0; i < height_; ++i) {
+    long long factor = common / denominators_[i];
+    if (factor != 1) {
+      for (int j = 0; j < width_; ++j) {
+        row(i)[j] = Narrow(static_cast<__int128>(row(i)[j]) * factor);
+      }
+    }
+    denominators_[i] = common;
+  }
+}
+
+ScaledIntegerMatrix operator+(const ScaledIntegerMatrix& lmx,
+                              const ScaledIntegerMatrix& rmx) {
+  if (lmx.width_ != rmx.width_ || lmx.height_ != rmx.height_) {
+    throw MatrixWrongSizeError();
+  }
+  ScaledIntegerMatrix newMatrix(lmx.height_, lmx.width_);
+  for (int i = 0; i < lmx.height_; ++i) {
+    long long denominator = Lcm(lmx.denominators_[i], rmx.denominators_[i]);
+    long long lFactor = denominator / lmx.denominators_[i];
+    long long rFactor = denominator / rmx.denominators_[i];
+    for (int j = 0; j < lmx.width_; ++j) {
+      newMatrix.row(i)[j] =
+          Narrow(static_cast<__int128>(lmx.row(i)[j]) * lFactor +
+                 static_cast<__int128>(rmx.row(i)[j]) * rFactor);
+    }
+    newMatrix.denominators_[i] = denominator;
+  }
+  return newMatrix;
+}
+ScaledIntegerMatrix operator-(const ScaledIntegerMatrix& lmx,
+                              const ScaledIntegerMatrix& rmx) {
+  ScaledIntegerMatrix negative(rmx);
+  for (long long& numerator : negative.numerators_) {
+    numerator = -numerator;
+  }
+  return lmx + negative;
+}
+
+// With rmx brought to one denominator D, row i of the product is
+// lmx.numerators[i] * rmx.numerators / (lmx.denominators[i] * D). When the
+// numerators are small enough to rule out overflow the integer product runs
+// on the plain GEMM kernel, otherwise it is accumulated in 128 bits.
+ScaledIntegerMatrix operator*(const ScaledIntegerMatrix& lmx,
+                              const ScaledIntegerMatrix& rmx) {
+  if (lmx.width_ != rmx.height_) {
+    throw MatrixWrongSizeError();
+  }
+  ScaledIntegerMatrix common(rmx);
+  common.UnifyDenominators();
+  ScaledIntegerMatrix newMatrix(lmx.height_, rmx.width_);
+
+  long double bound = static_cast<long double>(lmx.getMaxAbsNumerator()) *
+                      common.getMaxAbsNumerator() * lmx.width_;
+  if (bound < kLongLongLimit) {
+    std::vector<const long long*> lRows(lmx.height_);
+    std::vector<const long long*> rRows(common.height_);
+    std::vector<long long*> newRows(newMatrix.height_);
+    for (int i = 0; i < lmx.height_; ++i) {
+      lRows[i] = lmx.row(i);
+      newRows[i] = newMatrix.row(i);
+    }
+    for (int i = 0; i < common.height_; ++i) {
+      rRows[i] = common.row(i);
+    }
+    GemmKernel<long long, false>(lmx.height_, rmx.width_, lmx.width_,
+                                 lRows.data(), 0, rRows.data(), 0,
+                                 newRows.data(), 0);
+  } else {
+    std::vector<__int128> sums(rmx.width_);
+    for (int i = 0; i < lmx.height_; ++i) {
+      std::fill(sums.begin(), sums.end(), 0);
+      for (int k = 0; k < lmx.width_; ++k) {
+        const long long element = lmx.row(i)[k];
+        const long long* rRow = common.row(k);
+        for (int j = 0; j < rmx.width_; ++j) {
+          sums[j] += static_cast<__int128>(element) * rRow[j];
+        }
+      }
+      for (int j = 0; j < rmx.width_; ++j) {
+        newMatrix.row(i)[j] = Narrow(sums[j]);
+      }
+    }
+  }
+
+  long long denominator = common.height_ > 0 ? common.denominators_[0] : 1;
+  for (int i = 0; i < newMatrix.height_; ++i) {
+    newMatrix.denominators_[i] =
+        Narrow(static_cast<__int128>(lmx.denominators_[i]) * denominator);
+  }
+  newMatrix.ReduceRows();
+  return newMatrix;
+}
+
+// Every intermediate value of the Bareiss elimination is a minor of the
+// original numerators, so the divisions by the previous pivot are exact.
+// Gauss-Jordan form updates the rows above the pivot as well and leaves
+// p * I on the left and p * numerators^-1 in *inverse, p being the last pivot.
+long long ScaledIntegerMatrix::BareissAlgorithm(
+    std::vector<long long>* inverse) const {
+  int size = height_;
+  std::vector<long long> field(numerators_);
+  auto at = [size](std::vector<long long>& values, int i, int j) -> long long& {
+    return values[i * size + j];
+  };
+
+  int sign = 1;
+  long long previous = 1;
+  for (int k = 0; k < size; ++k) {
+    if (at(field, k, k) == 0) {
+      int pivot = k + 1;
+      while (pivot < size && at(field, pivot, k) == 0) {
+        ++pivot;
+      }
+      if (pivot == size) {
+        return 0;
+      }
+      std::swap_ranges(&at(field, k, 0), &at(field, k, 0) + size,
+                       &at(field, pivot, 0));
+      if (inverse != nullptr) {
+        std::swap_ranges(&at(*inverse, k, 0), &at(*inverse, k, 0) + size,
+                         &at(*inverse, pivot, 0));
+      }
+      MATRIX_COUNT(kPivotSwaps, 1);
+      sign = -sign;
+    }
+    const long long pivotValue = at(field, k, k);
+    for (int i = inverse != nullptr ? 0 : k + 1; i < size; ++i) {
+      if (i == k) {
+        continue;
+      }
+      const long long multiplier = at(field, i, k);
+      for (int j = inverse != nullptr ? 0 : k + 1; j < size; ++j) {
+        if (j != k) {
+          at(field, i, j) = Narrow(
+              (static_cast<__int128>(pivotValue) * at(field, i, j) -
+               static_cast<__int128>(multiplier) * at(field, k, j)) /
+              previous);
+        }
+      }
+      if (inverse != nullptr) {
+        for (int j = 0; j < size; ++j) {
+          at(*inverse, i, j) = Narrow(
+              (static_cast<__int128>(pivotValue) * at(*inverse, i, j) -
+               static_cast<__int128>(multiplier) * at(*inverse, k, j)) /
+              previous);
+        }
+      }
+      at(field, i, k) = 0;
+    }
+    previous = pivotValue;
+  }
+  return inverse != nullptr ? previous : sign * previous;
+}
+
+Rational ScaledIntegerMatrix::getDeterminant() const {
+  if (height_ != width_) {
+    throw MatrixWrongSizeError();
+  }
+  Rational det(BareissAlgorithm(nullptr));
+  for (long long denominator : denominators_) {
+    det /= Rational(denominator);
+  }
+  return det;
+}
+
+// With A = D^-1 * N for the numerators N and denominators D the inverse is
+// N^-1 * D, so column j of the result is scaled by the denominator of row j.
+ScaledIntegerMatrix ScaledIntegerMatrix::getInverse() const {
+  if (height_ != width_) {
+    throw MatrixWrongSizeError();
+  }
+  int size = height_;
+  std::vector<long long> inverse(size * size, 0);
+  for (int i = 0; i < size; ++i) {
+    inverse[i * size + i] = 1;
+  }
+  long long lastPivot = BareissAlgorithm(&inverse);
+  if (lastPivot == 0) {
+    throw MatrixIsDegenerateError();
+  }
+
+  ScaledIntegerMatrix newMatrix(size, size);
+  int sign = lastPivot < 0 ? -1 : 1;
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      newMatrix.row(i)[j] =
+          Narrow(static_cast<__int128>(sign * inverse[i * size + j]) *
+                 denominators_[j]);
+    }
+    newMatrix.denominators_[i] = sign * lastPivot;
+  }
+  newMatrix.ReduceRows();
+  return newMatrix;
+}
+
+std::ostream& operator<<(std::ostream& os, const ScaledIntegerMatrix& matrix) {
+  for (int i = 0; i < matrix.height_; ++i) {
+    for (int j = 0; j < matrix.width_; ++j) {
+      os << matrix(i, j) << ' ';
+    }
+    os << '\n';
+  }
+  return os;
+}
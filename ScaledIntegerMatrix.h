@@ -0,0 +1,71 @@
+#ifndef MATRIX_SCALEDINTEGERMATRIX_H
+#define MATRIX_SCALEDINTEGERMATRIX_H
+
+#include <vector>
+
+#include "Rational.h"
+#include "SquareMatrix.cpp"
+
+class IntegerOverflowError : public std::exception {
+  const char* what() const noexcept override {
+    return "Intermediate value doesn't fit into long long";
+  }
+};
+
+enum class DenominatorScope { kMatrix, kRow };
+
+// Rational matrix kept as an integer matrix plus one positive denominator
+// per row: element (i, j) equals numerator(i, j) / denominator(i). Sums,
+// products and elimination run on the integers only, and elements are
+// reduced to Rational just once, when the result is read back.
+class ScaledIntegerMatrix {
+ public:
+  ScaledIntegerMatrix(int height, int width);
+  // With DenominatorScope::kMatrix all the rows share one denominator.
+  explicit ScaledIntegerMatrix(const Matrix<Rational>& matrix,
+                               DenominatorScope scope = DenominatorScope::kRow);
+
+  int getRowsNumber() const { return height_; }
+  int getColumnsNumber() const { return width_; }
+
+  long long getNumerator(int positionHeight, int positionWidth) const;
+  long long getDenominator(int positionHeight) const;
+  Rational operator()(int positionHeight, int positionWidth) const;
+
+  Matrix<Rational> getRationalMatrix() const;
+
+  Rational getDeterminant() const;
+  ScaledIntegerMatrix getInverse() const;
+
+  friend ScaledIntegerMatrix operator+(const ScaledIntegerMatrix& lmx,
+                                       const ScaledIntegerMatrix& rmx);
+  friend ScaledIntegerMatrix operator-(const ScaledIntegerMatrix& lmx,
+                                       const ScaledIntegerMatrix& rmx);
+  friend ScaledIntegerMatrix operator*(const ScaledIntegerMatrix& lmx,
+                                       const ScaledIntegerMatrix& rmx);
+
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const ScaledIntegerMatrix& matrix);
+
+ private:
+  long long* row(int i) { return numerators_.data() + i * width_; }
+  const long long* row(int i) const {
+    return numerators_.data() + i * width_;
+  }
+  long long getMaxAbsNumerator() const;
+  // Divides every row by the gcd of its numerators and its denominator.
+  void ReduceRows();
+  // Brings all rows to the least common multiple of their denominators.
+  void UnifyDenominators();
+  // Fraction-free (Bareiss) elimination of the numerators. Without inverse
+  // returns det(numerators) or 0. With it also turns *inverse from the
+  // identity into adj(numerators) (up to the sign of the result).
+  long long BareissAlgorithm(std::vector<long long>* inverse) const;
+
+  int height_ = 0;
+  int width_ = 0;
+  std::vector<long long> numerators_;
+  std::vector<long long> denominators_;
+};
+
+#endif
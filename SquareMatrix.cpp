@@ -1,3 +1,7 @@
+#ifndef MATRIX_SQUAREMATRIX_CPP
+#define MATRIX_SQUAREMATRIX_CPP
+
+#include "BlockedGauss.cpp"
 #include "Matrix.cpp"
 
 class MatrixIsDegenerateError : public std::exception {
@@ -16,10 +20,9 @@ class SquareMatrix : public Matrix<T> {
       this->ClearMatrix();
       this->width_ = other.width_;
       this->height_ = other.height_;
-      this->matrixField_ = new T*[this->height_];
-      for (int i = 0; i < this->height_; ++i) {
-        this->matrixField_[i] = new T[this->width_];
-      }
+      MATRIX_COUNT(kDeepCopies, 1);
+      this->matrixField_ =
+          Matrix<T>::AllocateField(this->height_, this->width_);
       for (int i = 0; i < this->height_; ++i) {
         for (int j = 0; j < this->width_; ++j) {
           this->matrixField_[i][j] = other(i, j);
@@ -30,12 +33,15 @@ class SquareMatrix : public Matrix<T> {
   }
 
   T getTrace() const;
-  T getDeterminant() const;
+  // Long computations check the optional control for cancellation between
+  // blocks and report their progress to it.
+  T getDeterminant(OperationControl* control = nullptr) const;
 
   int getSize() const;
 
   SquareMatrix& invert();
-  SquareMatrix getInverse() const;
+  SquareMatrix getInverse(OperationControl* control = nullptr) const;
+  SquareMatrix getPower(long long exponent) const;
 
   SquareMatrix& Transpose();
   SquareMatrix getTransposed();
@@ -66,6 +72,14 @@ class SquareMatrix : public Matrix<T> {
   template <typename U, typename M>
   friend void CreateInvert(SquareMatrix<M>& ematrix, SquareMatrix<U>& matrix,
                            bool& isDetZero);
+  template <typename U>
+  friend void BlockedGaussAlgorithm(SquareMatrix<U>& matrix, bool& isDetZero,
+                                    int& stringSwapsCounter,
+                                    OperationControl* control);
+  template <typename U>
+  friend void BlockedCreateInvert(SquareMatrix<U>& eMatrix,
+                                  SquareMatrix<U>& matrix, bool& isDetZero,
+                                  OperationControl* control);
 };
 
 template <typename T>
@@ -86,10 +100,7 @@ template <typename T>
 SquareMatrix<T>::SquareMatrix(const int size) {
   this->width_ = size;
   this->height_ = size;
-  this->matrixField_ = new T*[size];
-  for (int i = 0; i < size; ++i) {
-    this->matrixField_[i] = new T[size];
-  }
+  this->matrixField_ = Matrix<T>::AllocateField(size, size);
   for (int i = 0; i < size; ++i) {
     for (int j = 0; j < size; ++j) {
       (*this)(i, j) = getZero<T>();
@@ -100,10 +111,8 @@ template <typename T>
 SquareMatrix<T>::SquareMatrix(const Matrix<T>& other) {
   int size = other.getColumnsNumber();
   this->height_ = this->width_ = size;
-  this->matrixField_ = new T*[size];
-  for (int i = 0; i < size; ++i) {
-    this->matrixField_[i] = new T[size];
-  }
+  MATRIX_COUNT(kDeepCopies, 1);
+  this->matrixField_ = Matrix<T>::AllocateField(size, size);
   for (int i = 0; i < this->width_; ++i) {
     for (int j = 0; j < this->width_; ++j) {
       (*this)(i, j) = other(i, j);
@@ -122,6 +131,7 @@ T SquareMatrix<T>::getTrace() const {
 
 template <typename T>
 SquareMatrix<T>& SquareMatrix<T>::invert() {
+  MATRIX_SCOPED_TIMER("SquareMatrix inverse");
   bool isDetZero = false;
   SquareMatrix<T> matrix(*this);
   SquareMatrix<T> eMatrix(this->getSize());
@@ -134,7 +144,11 @@ SquareMatrix<T>& SquareMatrix<T>::invert() {
       }
     }
   }
-  CreateInvert(eMatrix, matrix, isDetZero);
+  if (this->getSize() >= kGaussBlockedThreshold) {
+    BlockedCreateInvert(eMatrix, matrix, isDetZero, nullptr);
+  } else {
+    CreateInvert(eMatrix, matrix, isDetZero);
+  }
   *this = eMatrix;
   if (isDetZero) {
     throw MatrixIsDegenerateError();
@@ -143,7 +157,8 @@ SquareMatrix<T>& SquareMatrix<T>::invert() {
   }
 }
 template <typename T>
-SquareMatrix<T> SquareMatrix<T>::getInverse() const {
+SquareMatrix<T> SquareMatrix<T>::getInverse(OperationControl* control) const {
+  MATRIX_SCOPED_TIMER("SquareMatrix inverse");
   bool isDetZero = false;
   SquareMatrix<T> matrix(*this);
   SquareMatrix<T> eMatrix(this->getSize());
@@ -156,7 +171,17 @@ SquareMatrix<T> SquareMatrix<T>::getInverse() const {
       }
     }
   }
-  CreateInvert(eMatrix, matrix, isDetZero);
+  if (this->getSize() >= kGaussBlockedThreshold) {
+    BlockedCreateInvert(eMatrix, matrix, isDetZero, control);
+  } else {
+    if (control != nullptr) {
+      control->ThrowIfCancelled();
+    }
+    CreateInvert(eMatrix, matrix, isDetZero);
+    if (control != nullptr) {
+      control->completeStep();
+    }
+  }
   if (isDetZero) {
     throw MatrixIsDegenerateError();
   } else {
@@ -165,12 +190,45 @@ SquareMatrix<T> SquareMatrix<T>::getInverse() const {
 }
 
 template <typename T>
-T SquareMatrix<T>::getDeterminant() const {
+SquareMatrix<T> SquareMatrix<T>::getPower(long long exponent) const {
+  SquareMatrix<T> base(exponent < 0 ? getInverse() : *this);
+  if (exponent < 0) {
+    exponent = -exponent;
+  }
+  SquareMatrix<T> result(this->getSize());
+  for (int i = 0; i < result.width_; ++i) {
+    result(i, i) = getOne<T>();
+  }
+  while (exponent > 0) {
+    if (exponent % 2 == 1) {
+      result = result * base;
+    }
+    exponent /= 2;
+    if (exponent > 0) {
+      base = base * base;
+    }
+  }
+  return result;
+}
+
+template <typename T>
+T SquareMatrix<T>::getDeterminant(OperationControl* control) const {
+  MATRIX_SCOPED_TIMER("SquareMatrix determinant");
   bool isDetZero = false;
   T Det = 1;
   SquareMatrix<T> matrix(*this);
   int stringSwapsCounter = 0;
-  GaussAlgorithm(matrix, isDetZero, stringSwapsCounter);
+  if (this->getSize() >= kGaussBlockedThreshold) {
+    BlockedGaussAlgorithm(matrix, isDetZero, stringSwapsCounter, control);
+  } else {
+    if (control != nullptr) {
+      control->ThrowIfCancelled();
+    }
+    GaussAlgorithm(matrix, isDetZero, stringSwapsCounter);
+    if (control != nullptr) {
+      control->completeStep();
+    }
+  }
   if (isDetZero) {
     return 0;
   } else {
@@ -192,6 +250,8 @@ void CreateInvert(SquareMatrix<T>& eMatrix, SquareMatrix<U>& matrix,
       for (int j = i + 1; j < size; ++j) {
         if (matrix(j, i) != 0) {
           T temp = matrix(j, i) / matrix(i, i);
+          MATRIX_COUNT(kMultiplications, 2 * size);
+          MATRIX_COUNT(kAdditions, 2 * size);
           for (int k = 0; k < size; ++k) {
             matrix(j, k) -= matrix(i, k) * temp;
             eMatrix(j, k) -= eMatrix(i, k) * temp;
@@ -204,6 +264,7 @@ void CreateInvert(SquareMatrix<T>& eMatrix, SquareMatrix<U>& matrix,
         if (matrix(j, i) != 0) {
           std::swap(matrix.matrixField_[i], matrix.matrixField_[j]);
           std::swap(eMatrix.matrixField_[i], eMatrix.matrixField_[j]);
+          MATRIX_COUNT(kPivotSwaps, 1);
           isThereZeroSubMatrix = false;
           break;
         }
@@ -222,6 +283,8 @@ void CreateInvert(SquareMatrix<T>& eMatrix, SquareMatrix<U>& matrix,
     for (int i = size - 1; i >= 0; --i) {
       for (int j = i - 1; j >= 0; --j) {
         T temp = matrix(j, i) / matrix(i, i);
+        MATRIX_COUNT(kMultiplications, 2 * size);
+        MATRIX_COUNT(kAdditions, 2 * size);
         for (int k = size - 1; k >= 0; --k) {
           matrix(j, k) -= matrix(i, k) * temp;
           eMatrix(j, k) -= eMatrix(i, k) * temp;
@@ -248,6 +311,8 @@ void GaussAlgorithm(SquareMatrix<T>& matrix, bool& isDetZero,
       for (int j = i + 1; j < size; ++j) {
         if (matrix(j, i) != 0) {
           T temp = matrix(j, i) / matrix(i, i);
+          MATRIX_COUNT(kMultiplications, size - i);
+          MATRIX_COUNT(kAdditions, size - i);
           for (int k = i; k < size; ++k) {
             matrix(j, k) -= matrix(i, k) * temp;
           }
@@ -259,6 +324,7 @@ void GaussAlgorithm(SquareMatrix<T>& matrix, bool& isDetZero,
         if (matrix(j, i) != 0) {
           std::swap(matrix.matrixField_[i], matrix.matrixField_[j]);
           ++stringSwapsCounter;
+          MATRIX_COUNT(kPivotSwaps, 1);
           isThereZeroSubMatrix = false;
           break;
         }
@@ -274,6 +340,61 @@ void GaussAlgorithm(SquareMatrix<T>& matrix, bool& isDetZero,
   }
 }
 
+template <typename T>
+void BlockedGaussAlgorithm(SquareMatrix<T>& matrix, bool& isDetZero,
+                           int& stringSwapsCounter, OperationControl* control) {
+  std::vector<int> pivots;
+  if (control != nullptr) {
+    control->setTotalSteps(
+        (matrix.getSize() + kGaussBlockSize - 1) / kGaussBlockSize);
+  }
+  isDetZero = !BlockedLuFactorize(matrix.matrixField_, matrix.getSize(),
+                                  pivots, stringSwapsCounter, control);
+}
+template <typename T>
+void BlockedCreateInvert(SquareMatrix<T>& eMatrix, SquareMatrix<T>& matrix,
+                         bool& isDetZero, OperationControl* control) {
+  int size = matrix.getSize();
+  std::vector<int> pivots;
+  int stringSwapsCounter = 0;
+  // One step per panel of the factorization and per solved column tile.
+  if (control != nullptr) {
+    int tilesNumber = (size + kGaussBlockSize - 1) / kGaussBlockSize;
+    control->setTotalSteps(2 * tilesNumber);
+  }
+  if (!BlockedLuFactorize(matrix.matrixField_, size, pivots,
+                          stringSwapsCounter, control)) {
+    isDetZero = true;
+    return;
+  }
+  for (int i = 0; i < size; ++i) {
+    std::swap(eMatrix.matrixField_[i], eMatrix.matrixField_[pivots[i]]);
+  }
+
+  std::vector<std::future<void>> tilesSolved;
+  for (int first = 0; first < size; first += kGaussBlockSize) {
+    int last = std::min(size, first + kGaussBlockSize);
+    T** lu = matrix.matrixField_;
+    T** rhs = eMatrix.matrixField_;
+    tilesSolved.push_back(getMatrixThreadPool().submit(
+        [lu, rhs, size, first, last, control]() {
+          if (control != nullptr && control->isCancelled()) {
+            return;
+          }
+          SolveTile(lu, rhs, size, first, last);
+          if (control != nullptr) {
+            control->completeStep();
+          }
+        }));
+  }
+  for (std::future<void>& solved : tilesSolved) {
+    solved.get();
+  }
+  if (control != nullptr) {
+    control->ThrowIfCancelled();
+  }
+}
+
 template <typename T>
 SquareMatrix<T> operator+(const SquareMatrix<T>& lmx,
                           const SquareMatrix<T>& rmx) {
@@ -303,9 +424,11 @@ SquareMatrix<T> operator*(const M& value, const SquareMatrix<T>& lmx) {
 
 template <typename T, typename M>
 Matrix<T> operator*(const SquareMatrix<T>& lmx, const Matrix<M>& rmx) {
-  return lmx * Matrix<M>(lmx);
+  return Matrix<T>(lmx) * rmx;
 }
 template <typename T, typename M>
 Matrix<T> operator*(const Matrix<T>& lmx, const SquareMatrix<M>& rmx) {
   return lmx * Matrix<M>(rmx);
-}
\ No newline at end of file
+}
+
+#endif
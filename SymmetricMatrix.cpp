@@ -0,0 +1,277 @@
+#ifndef MATRIX_SYMMETRICMATRIX_CPP
+#define MATRIX_SYMMETRICMATRIX_CPP
+
+#include <cmath>
+#include <vector>
+
+#include "SquareMatrix.cpp"
+#include "TriangularMatrix.cpp"
+
+class MatrixIsNotSymmetricError : public std::exception {
+  const char* what() const noexcept override {
+    return "Matrix differs from its transposed one";
+  }
+};
+
+class MatrixIsNotPositiveDefiniteError : public std::exception {
+  const char* what() const noexcept override {
+    return "Matrix isn't positive definite - Cholesky factor doesn't exist";
+  }
+};
+
+// Symmetric matrix keeping only its lower triangle packed by rows.
+template <typename T>
+class SymmetricMatrix {
+ public:
+  explicit SymmetricMatrix(int size);
+  explicit SymmetricMatrix(const SquareMatrix<T>& other);
+
+  int getSize() const { return lower_.getSize(); }
+
+  T getTrace() const { return lower_.getTrace(); }
+  T getDeterminant() const;
+
+  // Lower factor L with L * L^T equal to the matrix.
+  TriangularMatrix<T> getCholeskyFactor() const;
+  // Lower matrix holding D on the diagonal and the unit factor L below it,
+  // so that the matrix equals L * D * L^T.
+  TriangularMatrix<T> getLdltFactor() const;
+
+  SquareMatrix<T> getSquareMatrix() const;
+
+  T& operator()(int positionHeight, int positionWidth);
+  T operator()(int positionHeight, int positionWidth) const;
+
+  template <typename M>
+  friend SymmetricMatrix<M> operator+(const SymmetricMatrix<M>& lmx,
+                                      const SymmetricMatrix<M>& rmx);
+  template <typename M>
+  friend SymmetricMatrix<M> operator-(const SymmetricMatrix<M>& lmx,
+                                      const SymmetricMatrix<M>& rmx);
+  template <typename M>
+  friend Matrix<M> operator*(const SymmetricMatrix<M>& lmx,
+                             const Matrix<M>& rmx);
+
+  template <typename M>
+  friend SymmetricMatrix<M> MultiplyByTransposed(const Matrix<M>& matrix);
+  template <typename M>
+  friend bool LdltAlgorithm(const SymmetricMatrix<M>& matrix,
+                            TriangularMatrix<M>& factor);
+
+  template <typename M>
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const SymmetricMatrix<M>& matrix);
+
+ private:
+  const T* row(int i) const { return lower_.line(i); }
+  T* row(int i) { return lower_.line(i); }
+
+  TriangularMatrix<T> lower_;
+};
+
+template <typename T>
+SymmetricMatrix<T>::SymmetricMatrix(const int size)
+    : lower_(size, TriangleKind::kLower) {}
+
+template <typename T>
+SymmetricMatrix<T>::SymmetricMatrix(const SquareMatrix<T>& other)
+    : lower_(other.getSize(), TriangleKind::kLower) {
+  for (int i = 0; i < getSize(); ++i) {
+    for (int j = 0; j <= i; ++j) {
+      if (other(i, j) != other(j, i)) {
+        throw MatrixIsNotSymmetricError();
+      }
+      row(i)[j] = other(i, j);
+    }
+  }
+}
+
+template <typename T>
+T& SymmetricMatrix<T>::operator()(const int positionHeight,
+                                  const int positionWidth) {
+  return positionWidth <= positionHeight
+             ? lower_(positionHeight, positionWidth)
+             : lower_(positionWidth, positionHeight);
+}
+template <typename T>
+T SymmetricMatrix<T>::operator()(const int positionHeight,
+                                 const int positionWidth) const {
+  return positionWidth <= positionHeight
+             ? lower_(positionHeight, positionWidth)
+             : lower_(positionWidth, positionHeight);
+}
+
+template <typename T>
+SquareMatrix<T> SymmetricMatrix<T>::getSquareMatrix() const {
+  SquareMatrix<T> newMatrix(getSize());
+  for (int i = 0; i < getSize(); ++i) {
+    for (int j = 0; j <= i; ++j) {
+      newMatrix(i, j) = newMatrix(j, i) = row(i)[j];
+    }
+  }
+  return newMatrix;
+}
+
+// Computes the LDL^T factorization without pivoting. Returns false when a
+// zero pivot shows up and the factorization doesn't exist in this order.
+template <typename T>
+bool LdltAlgorithm(const SymmetricMatrix<T>& matrix,
+                   TriangularMatrix<T>& factor) {
+  int size = matrix.getSize();
+  factor = TriangularMatrix<T>(size, TriangleKind::kLower);
+  // scaled[k] keeps L(i, k) * D(k) of the current row.
+  std::vector<T> scaled(size);
+  for (int i = 0; i < size; ++i) {
+    const T* row = matrix.row(i);
+    T* factorRow = factor.line(i);
+    for (int j = 0; j <= i; ++j) {
+      const T* factorRowJ = factor.line(j);
+      T value = row[j];
+      for (int k = 0; k < j; ++k) {
+        value -= scaled[k] * factorRowJ[k];
+      }
+      if (j < i) {
+        scaled[j] = value;
+        factorRow[j] = value / factorRowJ[j];
+      } else if (value == getZero<T>()) {
+        return false;
+      } else {
+        factorRow[i] = value;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T>
+TriangularMatrix<T> SymmetricMatrix<T>::getLdltFactor() const {
+  TriangularMatrix<T> factor(getSize());
+  if (!LdltAlgorithm(*this, factor)) {
+    throw MatrixIsDegenerateError();
+  }
+  return factor;
+}
+
+template <typename T>
+TriangularMatrix<T> SymmetricMatrix<T>::getCholeskyFactor() const {
+  int size = getSize();
+  TriangularMatrix<T> factor(size, TriangleKind::kLower);
+  for (int i = 0; i < size; ++i) {
+    T* factorRow = factor.line(i);
+    for (int j = 0; j <= i; ++j) {
+      const T* factorRowJ = factor.line(j);
+      T value = row(i)[j];
+      for (int k = 0; k < j; ++k) {
+        value -= factorRow[k] * factorRowJ[k];
+      }
+      if (j < i) {
+        factorRow[j] = value / factorRowJ[j];
+      } else if (value <= getZero<T>()) {
+        throw MatrixIsNotPositiveDefiniteError();
+      } else {
+        factorRow[i] = std::sqrt(value);
+      }
+    }
+  }
+  return factor;
+}
+
+// The determinant is the product of D from LDL^T. Matrices which need
+// pivoting for it fall back to the general Gauss method.
+template <typename T>
+T SymmetricMatrix<T>::getDeterminant() const {
+  TriangularMatrix<T> factor(getSize());
+  if (LdltAlgorithm(*this, factor)) {
+    return factor.getDeterminant();
+  }
+  return getSquareMatrix().getDeterminant();
+}
+
+// Computes matrix * matrix^T (SYRK): only the lower triangle is evaluated,
+// every element being a dot product of two contiguous rows.
+template <typename T>
+SymmetricMatrix<T> MultiplyByTransposed(const Matrix<T>& matrix) {
+  SymmetricMatrix<T> newMatrix(matrix.height_);
+  for (int i = 0; i < matrix.height_; ++i) {
+    const T* rowI = matrix.matrixField_[i];
+    T* newRow = newMatrix.row(i);
+    for (int j = 0; j <= i; ++j) {
+      const T* rowJ = matrix.matrixField_[j];
+      T value = getZero<T>();
+      for (int k = 0; k < matrix.width_; ++k) {
+        value += rowI[k] * rowJ[k];
+      }
+      newRow[j] = value;
+    }
+  }
+  return newMatrix;
+}
+
+template <typename T>
+SymmetricMatrix<T> operator+(const SymmetricMatrix<T>& lmx,
+                             const SymmetricMatrix<T>& rmx) {
+  if (lmx.getSize() != rmx.getSize()) {
+    throw MatrixWrongSizeError();
+  }
+  SymmetricMatrix<T> newMatrix(lmx);
+  for (int i = 0; i < lmx.getSize(); ++i) {
+    for (int j = 0; j <= i; ++j) {
+      newMatrix.row(i)[j] += rmx.row(i)[j];
+    }
+  }
+  return newMatrix;
+}
+template <typename T>
+SymmetricMatrix<T> operator-(const SymmetricMatrix<T>& lmx,
+                             const SymmetricMatrix<T>& rmx) {
+  if (lmx.getSize() != rmx.getSize()) {
+    throw MatrixWrongSizeError();
+  }
+  SymmetricMatrix<T> newMatrix(lmx);
+  for (int i = 0; i < lmx.getSize(); ++i) {
+    for (int j = 0; j <= i; ++j) {
+      newMatrix.row(i)[j] -= rmx.row(i)[j];
+    }
+  }
+  return newMatrix;
+}
+
+// Every stored element (i, k) below the diagonal contributes twice: to row i
+// through row k of rmx and to row k through row i of rmx.
+template <typename T>
+Matrix<T> operator*(const SymmetricMatrix<T>& lmx, const Matrix<T>& rmx) {
+  if (lmx.getSize() != rmx.height_) {
+    throw MatrixWrongSizeError();
+  }
+  Matrix<T> newMatrix(rmx.height_, rmx.width_);
+  for (int i = 0; i < lmx.getSize(); ++i) {
+    const T* row = lmx.row(i);
+    T* newRowI = newMatrix.matrixField_[i];
+    const T* rRowI = rmx.matrixField_[i];
+    for (int k = 0; k < i; ++k) {
+      T* newRowK = newMatrix.matrixField_[k];
+      const T* rRowK = rmx.matrixField_[k];
+      for (int j = 0; j < rmx.width_; ++j) {
+        newRowI[j] += row[k] * rRowK[j];
+        newRowK[j] += row[k] * rRowI[j];
+      }
+    }
+    for (int j = 0; j < rmx.width_; ++j) {
+      newRowI[j] += row[i] * rRowI[j];
+    }
+  }
+  return newMatrix;
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const SymmetricMatrix<T>& matrix) {
+  for (int i = 0; i < matrix.getSize(); ++i) {
+    for (int j = 0; j < matrix.getSize(); ++j) {
+      os << matrix(i, j) << ' ';
+    }
+    os << '\n';
+  }
+  return os;
+}
+
+#endif
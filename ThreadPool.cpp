@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(const int workersNumber) {
+  for (int i = 0; i < workersNumber; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    isStopped_ = true;
+  }
+  hasTask_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      hasTask_.wait(lock, [this]() { return isStopped_ || !tasks_.empty(); });
+      if (isStopped_ && tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+ThreadPool& getMatrixThreadPool() {
+  static ThreadPool pool(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  return pool;
+}
+
+// Operations submit their blocks to the matrix pool, so it is created first:
+// statics are destroyed in reverse order, and the operation pool then drains
+// its remaining operations while the matrix pool is still alive.
+ThreadPool& getOperationThreadPool() {
+  getMatrixThreadPool();
+  static ThreadPool pool(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  return pool;
+}
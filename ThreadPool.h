@@ -0,0 +1,57 @@
+#ifndef MATRIX_THREADPOOL_H
+#define MATRIX_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of workers taking tasks in FIFO order. A task may wait on
+// the future of a task submitted before it: FIFO order guarantees that such a
+// dependency is already running or finished, so the pool cannot deadlock.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int workersNumber);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  int getWorkersNumber() const { return static_cast<int>(workers_.size()); }
+
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> submit(F task);
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable hasTask_;
+  bool isStopped_ = false;
+};
+
+template <typename F>
+std::future<typename std::result_of<F()>::type> ThreadPool::submit(F task) {
+  using R = typename std::result_of<F()>::type;
+  auto packed = std::make_shared<std::packaged_task<R()>>(std::move(task));
+  std::future<R> result = packed->get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.emplace_back([packed]() { (*packed)(); });
+  }
+  hasTask_.notify_one();
+  return result;
+}
+
+// Shared pool used by the parallel matrix algorithms.
+ThreadPool& getMatrixThreadPool();
+// Pool running whole asynchronous operations. They wait for the blocks they
+// submit to the matrix pool, so they must not occupy its workers.
+ThreadPool& getOperationThreadPool();
+
+#endif
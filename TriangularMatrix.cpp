@@ -0,0 +1,333 @@
+#ifndef MATRIX_TRIANGULARMATRIX_CPP
+#define MATRIX_TRIANGULARMATRIX_CPP
+
+#include <vector>
+
+#include "SquareMatrix.cpp"
+
+class MatrixIsNotTriangularError : public std::exception {
+  const char* what() const noexcept override {
+    return "Matrix has non-zero elements on both sides of the diagonal";
+  }
+};
+
+enum class TriangleKind { kLower, kUpper };
+
+// Triangular matrix keeping only n * (n + 1) / 2 elements. A lower matrix is
+// packed by rows and an upper one by columns, so both keep the elements of
+// every row (respectively column) of the triangle contiguous and transposing
+// only flips the kind.
+template <typename T>
+class TriangularMatrix {
+ public:
+  explicit TriangularMatrix(int size, TriangleKind kind = TriangleKind::kLower);
+  TriangularMatrix(const SquareMatrix<T>& other, TriangleKind kind);
+
+  int getSize() const { return size_; }
+  TriangleKind getKind() const { return kind_; }
+  bool isLower() const { return kind_ == TriangleKind::kLower; }
+
+  T getTrace() const;
+  T getDeterminant() const;
+
+  TriangularMatrix getInverse() const;
+  TriangularMatrix getTransposed() const;
+  SquareMatrix<T> getSquareMatrix() const;
+
+  T& operator()(int positionHeight, int positionWidth);
+  T operator()(int positionHeight, int positionWidth) const;
+
+  template <typename M>
+  friend TriangularMatrix<M> operator*(const TriangularMatrix<M>& lmx,
+                                       const TriangularMatrix<M>& rmx);
+  template <typename M>
+  friend Matrix<M> operator*(const TriangularMatrix<M>& lmx,
+                             const Matrix<M>& rmx);
+  template <typename M>
+  friend SquareMatrix<M> operator*(const TriangularMatrix<M>& lmx,
+                                   const SquareMatrix<M>& rmx);
+  template <typename M>
+  friend Matrix<M> operator*(const Matrix<M>& lmx,
+                             const TriangularMatrix<M>& rmx);
+
+  template <typename M>
+  friend Matrix<M> SolveTriangular(const TriangularMatrix<M>& matrix,
+                                   const Matrix<M>& rhs);
+
+  template <typename M>
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const TriangularMatrix<M>& matrix);
+
+  template <typename M>
+  friend class SymmetricMatrix;
+  template <typename M>
+  friend bool LdltAlgorithm(const SymmetricMatrix<M>& matrix,
+                            TriangularMatrix<M>& factor);
+
+ private:
+  bool isInTriangle(int positionHeight, int positionWidth) const;
+  int index(int positionHeight, int positionWidth) const;
+  // First element of row i of a lower matrix or of column i of an upper one.
+  const T* line(int i) const { return packedField_.data() + i * (i + 1) / 2; }
+  T* line(int i) { return packedField_.data() + i * (i + 1) / 2; }
+
+  int size_ = 0;
+  TriangleKind kind_ = TriangleKind::kLower;
+  std::vector<T> packedField_;
+};
+
+template <typename T>
+TriangularMatrix<T>::TriangularMatrix(const int size, const TriangleKind kind)
+    : size_(size),
+      kind_(kind),
+      packedField_(size * (size + 1) / 2, getZero<T>()) {}
+
+template <typename T>
+TriangularMatrix<T>::TriangularMatrix(const SquareMatrix<T>& other,
+                                      const TriangleKind kind)
+    : TriangularMatrix(other.getSize(), kind) {
+  for (int i = 0; i < size_; ++i) {
+    for (int j = 0; j < size_; ++j) {
+      if (isInTriangle(i, j)) {
+        packedField_[index(i, j)] = other(i, j);
+      } else if (other(i, j) != getZero<T>()) {
+        throw MatrixIsNotTriangularError();
+      }
+    }
+  }
+}
+
+template <typename T>
+bool TriangularMatrix<T>::isInTriangle(const int positionHeight,
+                                       const int positionWidth) const {
+  return isLower() ? positionWidth <= positionHeight
+                   : positionHeight <= positionWidth;
+}
+template <typename T>
+int TriangularMatrix<T>::index(const int positionHeight,
+                               const int positionWidth) const {
+  return isLower() ? positionHeight * (positionHeight + 1) / 2 + positionWidth
+                   : positionWidth * (positionWidth + 1) / 2 + positionHeight;
+}
+
+template <typename T>
+T& TriangularMatrix<T>::operator()(const int positionHeight,
+                                   const int positionWidth) {
+  if (positionHeight < 0 || positionHeight >= size_ || positionWidth < 0 ||
+      positionWidth >= size_ || !isInTriangle(positionHeight, positionWidth)) {
+    throw MatrixIndexError();
+  }
+  return packedField_[index(positionHeight, positionWidth)];
+}
+template <typename T>
+T TriangularMatrix<T>::operator()(const int positionHeight,
+                                  const int positionWidth) const {
+  if (positionHeight < 0 || positionHeight >= size_ || positionWidth < 0 ||
+      positionWidth >= size_) {
+    throw MatrixIndexError();
+  }
+  if (!isInTriangle(positionHeight, positionWidth)) {
+    return getZero<T>();
+  }
+  return packedField_[index(positionHeight, positionWidth)];
+}
+
+template <typename T>
+T TriangularMatrix<T>::getTrace() const {
+  T trace = getZero<T>();
+  for (int i = 0; i < size_; ++i) {
+    trace += line(i)[i];
+  }
+  return trace;
+}
+template <typename T>
+T TriangularMatrix<T>::getDeterminant() const {
+  T det = getOne<T>();
+  for (int i = 0; i < size_; ++i) {
+    det *= line(i)[i];
+  }
+  return det;
+}
+
+template <typename T>
+TriangularMatrix<T> TriangularMatrix<T>::getTransposed() const {
+  TriangularMatrix<T> newMatrix(*this);
+  newMatrix.kind_ = isLower() ? TriangleKind::kUpper : TriangleKind::kLower;
+  return newMatrix;
+}
+
+template <typename T>
+SquareMatrix<T> TriangularMatrix<T>::getSquareMatrix() const {
+  SquareMatrix<T> newMatrix(size_);
+  for (int i = 0; i < size_; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      if (isLower()) {
+        newMatrix(i, j) = line(i)[j];
+      } else {
+        newMatrix(j, i) = line(i)[j];
+      }
+    }
+  }
+  return newMatrix;
+}
+
+// The inverse of a triangular matrix is triangular of the same kind: column j
+// of the inverse of a lower matrix solves L x = e_j and vanishes above j.
+template <typename T>
+TriangularMatrix<T> TriangularMatrix<T>::getInverse() const {
+  if (!isLower()) {
+    return getTransposed().getInverse().getTransposed();
+  }
+  for (int i = 0; i < size_; ++i) {
+    if (line(i)[i] == getZero<T>()) {
+      throw MatrixIsDegenerateError();
+    }
+  }
+  TriangularMatrix<T> inverse(size_, TriangleKind::kLower);
+  for (int i = 0; i < size_; ++i) {
+    const T* row = line(i);
+    T* inverseRow = inverse.line(i);
+    for (int k = 0; k < i; ++k) {
+      const T* inverseRowK = inverse.line(k);
+      for (int j = 0; j <= k; ++j) {
+        inverseRow[j] -= row[k] * inverseRowK[j];
+      }
+    }
+    inverseRow[i] = getOne<T>();
+    for (int j = 0; j <= i; ++j) {
+      inverseRow[j] /= row[i];
+    }
+  }
+  return inverse;
+}
+
+template <typename T>
+TriangularMatrix<T> operator*(const TriangularMatrix<T>& lmx,
+                              const TriangularMatrix<T>& rmx) {
+  if (lmx.size_ != rmx.size_ || lmx.kind_ != rmx.kind_) {
+    throw MatrixWrongSizeError();
+  }
+  if (!lmx.isLower()) {
+    return (rmx.getTransposed() * lmx.getTransposed()).getTransposed();
+  }
+  TriangularMatrix<T> newMatrix(lmx.size_, TriangleKind::kLower);
+  for (int i = 0; i < lmx.size_; ++i) {
+    const T* lRow = lmx.line(i);
+    T* newRow = newMatrix.line(i);
+    for (int k = 0; k <= i; ++k) {
+      const T* rRow = rmx.line(k);
+      for (int j = 0; j <= k; ++j) {
+        newRow[j] += lRow[k] * rRow[j];
+      }
+    }
+  }
+  return newMatrix;
+}
+
+template <typename T>
+Matrix<T> operator*(const TriangularMatrix<T>& lmx, const Matrix<T>& rmx) {
+  if (lmx.size_ != rmx.height_) {
+    throw MatrixWrongSizeError();
+  }
+  Matrix<T> newMatrix(rmx.height_, rmx.width_);
+  for (int i = 0; i < lmx.size_; ++i) {
+    const T* line = lmx.line(i);
+    for (int k = 0; k <= i; ++k) {
+      // Row i of a lower matrix times row k of rmx, or column i of an upper
+      // matrix times row i of rmx added to row k.
+      int row = lmx.isLower() ? i : k;
+      int column = lmx.isLower() ? k : i;
+      T* newRow = newMatrix.matrixField_[row];
+      const T* rRow = rmx.matrixField_[column];
+      for (int j = 0; j < rmx.width_; ++j) {
+        newRow[j] += line[k] * rRow[j];
+      }
+    }
+  }
+  return newMatrix;
+}
+template <typename T>
+SquareMatrix<T> operator*(const TriangularMatrix<T>& lmx,
+                          const SquareMatrix<T>& rmx) {
+  return static_cast<SquareMatrix<T>>(lmx * static_cast<const Matrix<T>&>(rmx));
+}
+template <typename T>
+Matrix<T> operator*(const Matrix<T>& lmx, const TriangularMatrix<T>& rmx) {
+  if (lmx.width_ != rmx.size_) {
+    throw MatrixWrongSizeError();
+  }
+  Matrix<T> newMatrix(lmx.height_, lmx.width_);
+  for (int i = 0; i < lmx.height_; ++i) {
+    const T* lRow = lmx.matrixField_[i];
+    T* newRow = newMatrix.matrixField_[i];
+    for (int k = 0; k < rmx.size_; ++k) {
+      const T* line = rmx.line(k);
+      if (rmx.isLower()) {
+        const T element = lRow[k];
+        for (int j = 0; j <= k; ++j) {
+          newRow[j] += element * line[j];
+        }
+      } else {
+        for (int j = 0; j <= k; ++j) {
+          newRow[k] += lRow[j] * line[j];
+        }
+      }
+    }
+  }
+  return newMatrix;
+}
+
+// Solves matrix * X = rhs by forward (lower) or backward (upper) substitution.
+template <typename T>
+Matrix<T> SolveTriangular(const TriangularMatrix<T>& matrix,
+                          const Matrix<T>& rhs) {
+  if (matrix.size_ != rhs.height_) {
+    throw MatrixWrongSizeError();
+  }
+  for (int i = 0; i < matrix.size_; ++i) {
+    if (matrix.line(i)[i] == getZero<T>()) {
+      throw MatrixIsDegenerateError();
+    }
+  }
+  Matrix<T> solution(rhs);
+  T** rows = solution.matrixField_;
+  if (matrix.isLower()) {
+    for (int i = 0; i < matrix.size_; ++i) {
+      const T* line = matrix.line(i);
+      for (int k = 0; k < i; ++k) {
+        for (int j = 0; j < rhs.width_; ++j) {
+          rows[i][j] -= line[k] * rows[k][j];
+        }
+      }
+      for (int j = 0; j < rhs.width_; ++j) {
+        rows[i][j] /= line[i];
+      }
+    }
+  } else {
+    for (int k = matrix.size_ - 1; k >= 0; --k) {
+      const T* line = matrix.line(k);
+      for (int j = 0; j < rhs.width_; ++j) {
+        rows[k][j] /= line[k];
+      }
+      for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < rhs.width_; ++j) {
+          rows[i][j] -= line[i] * rows[k][j];
+        }
+      }
+    }
+  }
+  return solution;
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const TriangularMatrix<T>& matrix) {
+  for (int i = 0; i < matrix.size_; ++i) {
+    for (int j = 0; j < matrix.size_; ++j) {
+      os << matrix(i, j) << ' ';
+    }
+    os << '\n';
+  }
+  return os;
+}
+
+#endif
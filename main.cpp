@@ -1,9 +1,32 @@
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
+#include "BatchMode.h"
+#include "Instrumentation.h"
 #include "SquareMatrix.cpp"
 #include "Rational.h"
 
 
-int main() {
+int main(int argc, char** argv) {
+  Instrumentation::InstallExitSummary();
+  if (argc > 1 && std::string(argv[1]) == "--batch") {
+    int workersNumber =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    if (argc > 2) {
+      std::ifstream jobs(argv[2]);
+      if (!jobs) {
+        std::cerr << "Cannot open " << argv[2] << '\n';
+        return 1;
+      }
+      return RunBatchMode(jobs, std::cout, std::cerr, workersNumber) == 0 ? 0
+                                                                         : 1;
+    }
+    return RunBatchMode(std::cin, std::cout, std::cerr, workersNumber) == 0 ? 0
+                                                                           : 1;
+  }
+
   int m, n, p;
   Rational r;
   std::cin >> m >> n >> p >> r;